@@ -317,6 +317,108 @@ public:
     SgAsmInstruction *disassembleOne(const unsigned char *buf, rose_addr_t buf_va, size_t buf_size, rose_addr_t start_va,
                                      AddressSet *successors=NULL);
 
+    /** Compact description of one instruction.
+     *
+     *  This plain-old-data struct holds those properties of an instruction that are needed by linear sweeps, string finders,
+     *  call target scans, and similar tools that look at many instructions but only care about a few properties of each. It's
+     *  filled in by @ref decodeOne, it can be stored in ordinary containers and copied with memcpy, and it can be turned into
+     *  a full instruction AST with @ref upgrade when necessary. */
+    struct DecodedInstruction {
+        enum {
+            MAX_SIZE = 32,                              /**< Maximum number of instruction bytes stored. */
+            MAX_MNEMONIC = 16,                          /**< Maximum mnemonic length including NUL terminator. */
+            MAX_OPERANDS = 8,                           /**< Maximum number of operand kinds stored. */
+            MAX_SUCCESSORS = 2                          /**< Maximum number of successors stored. */
+        };
+
+        /** Kind of operand. */
+        enum OperandKind {
+            OPERAND_REGISTER,                           /**< Register reference expression. */
+            OPERAND_MEMORY,                             /**< Memory reference expression. */
+            OPERAND_IMMEDIATE,                          /**< Integer or floating-point constant. */
+            OPERAND_OTHER                               /**< Any other kind of expression. */
+        };
+
+        rose_addr_t address;                            /**< Starting address of the instruction. */
+        size_t size;                                    /**< Instruction size in bytes. */
+        uint8_t bytes[MAX_SIZE];                        /**< The first @c min(size,MAX_SIZE) bytes of the instruction. */
+        unsigned kind;                                  /**< Architecture-specific instruction kind; see @c get_anyKind. */
+        char mnemonic[MAX_MNEMONIC];                    /**< NUL-terminated mnemonic, truncated if necessary. */
+        size_t nOperands;                               /**< Number of operands, which can exceed @c MAX_OPERANDS. */
+        uint8_t operandKinds[MAX_OPERANDS];             /**< Kinds of the first @c MAX_OPERANDS operands. */
+        bool isUnknown;                                 /**< Whether this is an unknown instruction. */
+        bool terminatesBasicBlock;                      /**< Whether the instruction ends a basic block. */
+        bool isFunctionCall;                            /**< Whether the instruction is a function call. */
+        bool isFunctionReturn;                          /**< Whether the instruction is a function return. */
+        bool hasBranchTarget;                           /**< Whether @c branchTarget is valid. */
+        rose_addr_t branchTarget;                       /**< Branch target if known. */
+        size_t nSuccessors;                             /**< Number of successors stored in @c successors. */
+        rose_addr_t successors[MAX_SUCCESSORS];         /**< Concrete successor addresses. */
+        bool successorsComplete;                        /**< Whether @c successors lists all possible successors. */
+    };
+
+    /** Decode one instruction into a compact description.
+     *
+     *  Decodes the instruction at the specified address like @ref disassembleOne, but rather than returning an AST the
+     *  instruction's properties are stored in the caller-supplied @p decoded struct. This is useful when many instructions
+     *  need to be examined but few of them need to be kept.  Any AST nodes used during decoding are deleted before returning,
+     *  and the memory pools from which they were allocated reuse that memory for the next instruction, so decoding a long
+     *  sequence of instructions doesn't grow the pools. Subclasses override this to decode common instructions without
+     *  creating any AST nodes at all. Throws the same exceptions as @ref disassembleOne.
+     *
+     *  Thread safety: Same as @ref disassembleOne. */
+    virtual void decodeOne(const MemoryMap::Ptr &map, rose_addr_t va, DecodedInstruction &decoded /*out*/);
+
+    /** Create the full instruction AST for a decoded instruction.
+     *
+     *  Disassembles the bytes stored in the @p decoded struct at the address where they were decoded and returns the new
+     *  instruction. Throws the same exceptions as @ref disassembleOne.
+     *
+     *  Thread safety: Same as @ref disassembleOne. */
+    SgAsmInstruction* upgrade(const DecodedInstruction &decoded);
+
+    /** How @ref disassembleRange chooses the addresses to disassemble. */
+    enum SweepMode {
+        SWEEP_LINEAR,                                   /**< Continue after each instruction, or at the next address after a
+                                                         *   failure, like a linear sweep disassembler. */
+        SWEEP_ALL                                       /**< Disassemble at every address. */
+    };
+
+    /** Callback for @ref disassembleRange.
+     *
+     *  The callback is invoked once per disassembled address in increasing address order. If disassembly succeeded then @p
+     *  insn is the new instruction, which is owned by the callback, and @p error is null; otherwise @p insn is null and @p
+     *  error describes the failure. The callback returns false to stop the sweep early. */
+    class RangeCallback {
+    public:
+        virtual ~RangeCallback() {}
+        virtual bool operator()(rose_addr_t va, SgAsmInstruction *insn, const Exception *error) = 0;
+    };
+
+    /** Disassemble all instructions in an address range.
+     *
+     *  Disassembles the executable addresses of @p where that are multiples of @p alignment, either at every such address or
+     *  linearly from one instruction to the next according to @p mode, and invokes the callback for each in address order.
+     *  The range is split into chunks of about @p chunkSize bytes which are disassembled concurrently by @p nThreads threads
+     *  (zero means use the hardware concurrency), each with its own @ref clone of this disassembler.  Chunks are processed
+     *  in batches and their results are passed to the callback as each batch completes. A batch has at most four chunks per
+     *  thread and at most 64Ki addresses' results (one chunk if a chunk is larger than that), so memory use depends neither on
+     *  the size of the range nor on the number of threads, even in @ref SWEEP_ALL mode where every address has a result.
+     *
+     *  In @ref SWEEP_LINEAR mode a chunk's sweep starts at its first address, which might not be where the sweep from the
+     *  previous chunk would have continued.  The results are stitched together in the calling thread by disassembling
+     *  serially from where the previous chunk's sweep left off until it reaches an address where the chunk's sweep also
+     *  found an instruction, after which the two sweeps agree.  Therefore the callback sees exactly the same instructions
+     *  as it would from a serial linear sweep.
+     *
+     *  Returns the number of instructions passed to the callback.
+     *
+     *  Thread safety: This method is not thread safe, although it uses multiple threads internally. The callback is invoked
+     *  only from the calling thread. */
+    size_t disassembleRange(const MemoryMap::Ptr &map, const AddressInterval &where, RangeCallback &callback,
+                            SweepMode mode = SWEEP_LINEAR, size_t alignment = 1, size_t nThreads = 0,
+                            size_t chunkSize = 4096);
+
 
     /***************************************************************************************************************************
      *                                          Miscellaneous methods
@@ -114,6 +114,13 @@ public:
     virtual SgAsmInstruction *disassembleOne(const MemoryMap::Ptr &map, rose_addr_t start_va,
                                              AddressSet *successors=NULL) ROSE_OVERRIDE;
 
+    /** Decode one instruction into a compact description.
+     *
+     *  The common general-purpose integer instructions (arithmetic, moves, stack operations, and direct and indirect
+     *  branches, calls, and returns) are decoded straight from their bytes without creating any AST nodes. Other
+     *  instructions are decoded by the superclass, which disassembles them into a temporary AST. */
+    virtual void decodeOne(const MemoryMap::Ptr &map, rose_addr_t start_va, DecodedInstruction &decoded /*out*/) ROSE_OVERRIDE;
+
     virtual SgAsmInstruction *makeUnknownInstruction(const Exception&) ROSE_OVERRIDE;
 
 
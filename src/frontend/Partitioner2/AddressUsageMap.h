@@ -17,6 +17,7 @@
 #include <boost/foreach.hpp>
 #include <ostream>
 #include <string>
+#include <vector>
 
 namespace Rose {
 namespace BinaryAnalysis {
@@ -364,6 +365,12 @@ class AddressUsageMap {
     typedef Sawyer::Container::IntervalMap<AddressInterval, AddressUsers> Map;
     Map map_;
 
+    // Flat index used while the map is frozen. The intervals are sorted and parallel to the user pointers, which point into
+    // the nodes of map_. The index is discarded whenever map_ is modified.
+    bool isFrozen_;
+    std::vector<AddressInterval> flatIntervals_;
+    std::vector<const AddressUsers*> flatUsers_;
+
 #ifdef ROSE_HAVE_BOOST_SERIALIZATION_LIB
 private:
     friend class boost::serialization::access;
@@ -371,10 +378,31 @@ private:
     template<class S>
     void serialize(S &s, const unsigned /*version*/) {
         s & BOOST_SERIALIZATION_NVP(map_);
+        if (S::is_loading::value)
+            thaw();                                     // an index built before loading doesn't describe the loaded map
     }
 #endif
 
 public:
+    AddressUsageMap()
+        : isFrozen_(false) {}
+
+    AddressUsageMap(const AddressUsageMap &other)
+        : map_(other.map_), isFrozen_(false) {
+        if (other.isFrozen_)
+            freeze();
+    }
+
+    AddressUsageMap& operator=(const AddressUsageMap &other) {
+        if (this != &other) {
+            thaw();
+            map_ = other.map_;
+            if (other.isFrozen_)
+                freeze();
+        }
+        return *this;
+    }
+
     /** Determines whether a map is empty.
      *
      *  Returns true if the map contains no instructions or data, false if it contains at least one instruction or at least one
@@ -382,7 +410,26 @@ public:
     bool isEmpty() const { return map_.isEmpty(); }
 
     /** Reset map to initial empty state. */
-    void clear() { map_.clear(); }
+    void clear() { thaw(); map_.clear(); }
+
+    /** Optimize the map for queries.
+     *
+     *  The map is normally a balanced tree of intervals, which is efficient to modify but requires following many pointers for
+     *  each query.  Freezing the map builds an additional compact index: a sorted array of intervals that is searched with a
+     *  binary search.  While the map is frozen, the queries that are used most after partitioning (@ref exists, @ref anyExists,
+     *  @ref instructionExists, @ref basicBlockExists, @ref dataBlockExists, @ref spanning, and @ref overlapping) use the
+     *  index.  The partitioner freezes its map when partitioning is complete; see @ref Partitioner::freezeAum.
+     *
+     *  Freezing doesn't prevent modification. Any change to the map, which can only be made through the partitioner API,
+     *  discards the index, and the map must be frozen again to benefit from it. Freezing an already frozen map does nothing.
+     *
+     *  The index is not saved when the map is serialized, and loading a map leaves it thawed.
+     *
+     * @{ */
+    void freeze();
+    void thaw();
+    bool isFrozen() const { return isFrozen_; }
+    /** @} */
 
     /** Number of addresses represented by the map.
      *
@@ -405,7 +452,9 @@ public:
      *  Returns true if the specified address belongs to any instruction, basic block, or data block. This is a O(log N)
      *  operation where N is the number of contiguous intervals in this address usage map.  It may be slightly faster than some
      *  of the other methods since it doesn't need to construct a non-POD return value. */
-    bool exists(rose_addr_t va) const { return map_.exists(va); }
+    bool exists(rose_addr_t va) const {
+        return isFrozen_ ? flatFind(va) < flatIntervals_.size() : map_.exists(va);
+    }
 
     /** Predicate to determine whether any of the specified addresses are used.
      *
@@ -483,11 +532,21 @@ public:
     AddressUsers spanning(const AddressInterval &interval, UserPredicate userPredicate) const {
         AddressUsers retval;
         size_t nIters = 0;
-        BOOST_FOREACH (const Map::Node &node, map_.findAll(interval)) {
-            AddressUsers users = node.value().select(userPredicate);
-            retval = 0==nIters++ ? users : retval.intersection(users);
-            if (retval.isEmpty())
-                break;
+        if (isFrozen_) {
+            std::pair<size_t, size_t> range = flatFindAll(interval);
+            for (size_t i=range.first; i<range.second; ++i) {
+                AddressUsers users = flatUsers_[i]->select(userPredicate);
+                retval = 0==nIters++ ? users : retval.intersection(users);
+                if (retval.isEmpty())
+                    break;
+            }
+        } else {
+            BOOST_FOREACH (const Map::Node &node, map_.findAll(interval)) {
+                AddressUsers users = node.value().select(userPredicate);
+                retval = 0==nIters++ ? users : retval.intersection(users);
+                if (retval.isEmpty())
+                    break;
+            }
         }
         return retval;
     }
@@ -509,8 +568,14 @@ public:
     template<class UserPredicate>
     AddressUsers overlapping(const AddressInterval &interval, UserPredicate userPredicate) const {
         AddressUsers retval;
-        BOOST_FOREACH (const Map::Node &node, map_.findAll(interval))
-            retval.insert(node.value().select(userPredicate));
+        if (isFrozen_) {
+            std::pair<size_t, size_t> range = flatFindAll(interval);
+            for (size_t i=range.first; i<range.second; ++i)
+                retval.insert(flatUsers_[i]->select(userPredicate));
+        } else {
+            BOOST_FOREACH (const Map::Node &node, map_.findAll(interval))
+                retval.insert(node.value().select(userPredicate));
+        }
         return retval;
     }
     /** @} */
@@ -549,6 +614,15 @@ public:
 private:
     friend class Partitioner;
 
+    // Index of the frozen interval containing the address, or the number of intervals if none.
+    size_t flatFind(rose_addr_t) const;
+
+    // Half-open range of indexes of the frozen intervals that overlap the specified interval.
+    std::pair<size_t, size_t> flatFindAll(const AddressInterval&) const;
+
+    // Users at the specified address, or null if none.
+    const AddressUsers* usersAt(rose_addr_t) const;
+
     // Insert an instruction/block pair into the map.
     void insertInstruction(SgAsmInstruction*, const BasicBlock::Ptr&);
 
@@ -622,6 +622,7 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 private:
     friend class Partitioner;
+    friend class IndexedRba;
     void init(const Partitioner&);
     void freeze() { isFrozen_ = true; semantics_.optionalPenultimateState = Sawyer::Nothing(); }
     void thaw() { isFrozen_ = false; }
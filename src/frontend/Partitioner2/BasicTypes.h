@@ -82,6 +82,13 @@ enum SemanticMemoryParadigm {
     MAP_BASED_MEMORY                                    /**< Fast but not precise. */
 };
 
+/** How instructions are decoded ahead of the partitioner's serial requests. */
+enum InstructionPrefetch {
+    PREFETCH_NONE,                                      /**< Decode instructions only when the partitioner asks for them. */
+    PREFETCH_SEGMENTS,                                  /**< Linear sweep of all executable segments before partitioning. */
+    PREFETCH_PLACEHOLDERS                               /**< Speculatively decode blocks at pending placeholder addresses. */
+};
+
 /** Settings that control building the AST.
  *
  *  The runtime descriptions and command-line parser for these switches can be obtained from @ref
@@ -249,6 +256,10 @@ struct DisassemblerSettings {
     std::string isaName;                            /**< Name of the instruction set architecture. Specifying a non-empty
                                                      *   ISA name will override the architecture that's chosen from the
                                                      *   binary container(s) such as ELF or PE. */
+    InstructionPrefetch prefetching;                /**< Whether and how instructions are decoded in parallel ahead of
+                                                     *   the partitioner's requests. */
+    size_t prefetchBatchSize;                       /**< Minimum number of undiscovered placeholders that triggers a
+                                                     *   parallel prefetch when prefetching placeholders. */
 
 private:
     friend class boost::serialization::access;
@@ -256,9 +267,19 @@ private:
     template<class S>
     void serialize(S &s, unsigned version) {
         s & BOOST_SERIALIZATION_NVP(isaName);
+        if (version >= 1) {
+            s & BOOST_SERIALIZATION_NVP(prefetching);
+            s & BOOST_SERIALIZATION_NVP(prefetchBatchSize);
+        }
     }
+
+public:
+    DisassemblerSettings()
+        : prefetching(PREFETCH_NONE), prefetchBatchSize(256) {}
 };
 
+// BOOST_CLASS_VERSION(DisassemblerSettings, 1); -- see end of file (cannot be in a namespace)
+
 /** Controls whether the function may-return analysis runs. */
 enum FunctionReturnAnalysis {
     MAYRETURN_DEFAULT_YES,                          /**< Assume a function returns if the may-return analysis cannot
@@ -339,6 +360,7 @@ struct PartitionerSettings {
     bool doingPostFunctionStackDelta;               /**< Run function-stack-delta analysis if doingPostAnalysis is set? */
     bool doingPostCallingConvention;                /**< Run calling-convention analysis if doingPostAnalysis is set? */
     bool doingPostFunctionNoop;                     /**< Find and name functions that are effectively no-ops. */
+    size_t postAnalysisThreads;                     /**< Threads for post-partitioning analyses. 0 => use the global setting. */
     FunctionReturnAnalysis functionReturnAnalysis;  /**< How to run the function may-return analysis. */
     size_t functionReturnAnalysisMaxSorts;          /**< Number of times functions are sorted before using unsorted lists. */
     bool findingDataFunctionPointers;               /**< Look for function pointers in static data. */
@@ -415,6 +437,8 @@ private:
             if (S::is_loading::value)
                 syscallHeader = temp;
         }
+        if (version >= 6)
+            s & BOOST_SERIALIZATION_NVP(postAnalysisThreads);
     }
 
 public:
@@ -424,10 +448,11 @@ public:
           findingInterFunctionCalls(true), findingFunctionCallFunctions(true), findingEntryFunctions(true),
           findingErrorFunctions(true), findingImportFunctions(true), findingExportFunctions(true), findingSymbolFunctions(true),
           doingPostAnalysis(true), doingPostFunctionMayReturn(true), doingPostFunctionStackDelta(true),
-          doingPostCallingConvention(false), doingPostFunctionNoop(false), functionReturnAnalysis(MAYRETURN_DEFAULT_YES),
-          functionReturnAnalysisMaxSorts(50), findingDataFunctionPointers(false), findingCodeFunctionPointers(false),
-          findingThunks(true), splittingThunks(false), semanticMemoryParadigm(LIST_BASED_MEMORY), namingConstants(true),
-          namingStrings(true), namingSyscalls(true), demangleNames(true) {}
+          doingPostCallingConvention(false), doingPostFunctionNoop(false), postAnalysisThreads(0),
+          functionReturnAnalysis(MAYRETURN_DEFAULT_YES), functionReturnAnalysisMaxSorts(50), findingDataFunctionPointers(false),
+          findingCodeFunctionPointers(false), findingThunks(true), splittingThunks(false),
+          semanticMemoryParadigm(LIST_BASED_MEMORY), namingConstants(true), namingStrings(true), namingSyscalls(true),
+          demangleNames(true) {}
 };
 
 // BOOST_CLASS_VERSION(PartitionerSettings, 1); -- see end of file (cannot be in a namespace)
@@ -439,9 +464,11 @@ public:
 struct EngineSettings {
     std::vector<std::string> configurationNames;    /**< List of configuration files and/or directories. */
     bool exitOnError;                               /**< If true, emit error message and exit non-zero, else throw. */
+    bool savingIndexedRba;                          /**< If true, @ref Engine::savePartitioner writes an indexed RBA file
+                                                     *   (see @ref IndexedRba) instead of a single archive. */
 
     EngineSettings()
-        : exitOnError(true) {}
+        : exitOnError(true), savingIndexedRba(false) {}
 
 private:
     friend class boost::serialization::access;
@@ -450,6 +477,8 @@ private:
     void serialize(S &s, unsigned version) {
         s & BOOST_SERIALIZATION_NVP(configurationNames);
         s & BOOST_SERIALIZATION_NVP(exitOnError);
+        if (version >= 1)
+            s & BOOST_SERIALIZATION_NVP(savingIndexedRba);
     }
 };
 
@@ -469,6 +498,8 @@ typedef Sawyer::SharedPointer<ThunkPredicates> ThunkPredicatesPtr;
 } // namespace
 
 // Class versions must be at global scope
-BOOST_CLASS_VERSION(Rose::BinaryAnalysis::Partitioner2::PartitionerSettings, 5);
+BOOST_CLASS_VERSION(Rose::BinaryAnalysis::Partitioner2::DisassemblerSettings, 1);
+BOOST_CLASS_VERSION(Rose::BinaryAnalysis::Partitioner2::PartitionerSettings, 6);
+BOOST_CLASS_VERSION(Rose::BinaryAnalysis::Partitioner2::EngineSettings, 1);
 
 #endif
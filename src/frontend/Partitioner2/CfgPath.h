@@ -160,6 +160,19 @@ public:
      *  the path is at the front of the returned vector. */
     std::vector<ControlFlowGraph::ConstEdgeIterator>  backtrack();
 
+    /** Number of unexplored alternatives for an edge.
+     *
+     *  Returns the number of sibling edges that @ref backtrack will still follow at the specified position of the path. The
+     *  @p edgeIdx must be less than the number of edges in the path. */
+    size_t nAlternatives(size_t edgeIdx) const;
+
+    /** Remove an unexplored alternative for an edge.
+     *
+     *  Removes and returns the sibling edge that @ref backtrack would have followed last at the specified position of the
+     *  path, so that it can be explored some other way (such as by another thread). The position must have at least one
+     *  alternative. */
+    ControlFlowGraph::ConstEdgeIterator popAlternative(size_t edgeIdx);
+
     /** User-defined attributes for the nth vertex.
      *
      *  Each vertex in the path has a corresponding attribute storage system. The attribute storage lifetime is the same as
@@ -117,6 +117,7 @@ public:
 
 private:
     friend class Partitioner;
+    friend class IndexedRba;
     void freeze() { isFrozen_ = true; }
     void thaw() { isFrozen_ = false; }
     size_t incrementOwnerCount();
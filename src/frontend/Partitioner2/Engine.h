@@ -411,6 +411,45 @@ public:
     Partitioner partition(const std::string &fileName) /*final*/;
     /** @} */
 
+    /** Partition a modified specimen incrementally.
+     *
+     *  This is like @ref partition except results from a previous partitioner are reused where the bytes they depend on have
+     *  not changed. The intended use is re-analyzing successive builds of the same specimen that differ in only a few
+     *  functions. The steps are:
+     *
+     *  @li If the specimen is not loaded (@ref areSpecimensLoaded) then call @ref loadSpecimens. Alternatively, the new
+     *  memory map can be supplied by calling @ref memoryMap before calling this function with no file names.
+     *
+     *  @li Obtain a disassembler by calling @ref obtainDisassembler, using the previous partitioner's disassembler as the hint.
+     *
+     *  @li Create a partitioner by calling @ref createPartitioner.
+     *
+     *  @li Copy unchanged basic blocks and functions from the previous partitioner by calling @ref reusePartitionerResults.
+     *
+     *  @li Run the partitioner by calling @ref runPartitioner, which discovers only those parts of the specimen that were not
+     *  reused.
+     *
+     *  The previous partitioner is typically one that was saved with @ref savePartitioner and loaded with @ref
+     *  loadPartitioner. Its basic blocks are shared with the returned partitioner in the same way as when a partitioner is
+     *  copied, therefore the previous partitioner should not be modified afterward.
+     *
+     *  Exceptions are handled the same as for @ref partition. */
+    virtual Partitioner partitionIncrementally(const Partitioner &previous,
+                                               const std::vector<std::string> &fileNames = std::vector<std::string>());
+
+    /** Reuse unchanged results from a previous partitioner.
+     *
+     *  A basic block from the previous partitioner is unchanged if the bytes of each of its instructions and data blocks are
+     *  the same in both partitioners' memory maps and the instructions are still executable.  A function is unchanged if all
+     *  its basic blocks and data blocks are unchanged and all the functions it calls are unchanged.  Each unchanged function
+     *  is attached to the new partitioner along with its basic blocks, and the function's cached analysis results (stack
+     *  delta, calling convention, and the may-return results cached in its basic blocks) are retained so that @ref
+     *  updateAnalysisResults doesn't need to recompute them. The instructions of all unchanged basic blocks are added to the new
+     *  partitioner's instruction provider so they need not be disassembled again, even if their function changed.
+     *
+     *  This should be called on a new partitioner before it is run. Returns the number of functions reused. */
+    virtual size_t reusePartitionerResults(Partitioner &partitioner, const Partitioner &previous);
+
     /** Obtain an abstract syntax tree.
      *
      *  Constructs a new abstract syntax tree (AST) from partitioner information with these steps:
@@ -433,13 +472,18 @@ public:
      *
      *  The specified partitioner and the binary analysis components of the AST are saved into the specified file, which is
      *  created if it doesn't exist and truncated if it does exist. The name should end with a ".rba" extension. The file can
-     *  be loaded by passing its name to the @ref partition function or by calling @ref loadPartitioner. */
+     *  be loaded by passing its name to the @ref partition function or by calling @ref loadPartitioner.
+     *
+     *  If the engine's @c savingIndexedRba setting is enabled (the @c --indexed-rba switch), the file is written by @ref
+     *  IndexedRba::save instead. Such a file can be opened by tools without decoding everything, but does not contain the
+     *  AST. */
     virtual void savePartitioner(const Partitioner&, const boost::filesystem::path&, SerialIo::Format fmt = SerialIo::BINARY);
 
     /** Load a partitioner and an AST from a file.
      *
      *  The specified RBA file is opened and read to create a new @ref Partitioner object and associated AST. The @ref
-     *  partition function also understands how to open RBA files. */
+     *  partition function also understands how to open RBA files. Indexed RBA files written by @ref IndexedRba::save are
+     *  recognized by their contents and the partitioner is rebuilt with @ref IndexedRba::partitioner; they have no AST. */
     virtual Partitioner loadPartitioner(const boost::filesystem::path&, SerialIo::Format fmt = SerialIo::BINARY);
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -758,6 +802,14 @@ public:
      *  to implement a more directed approach to discovering basic blocks. */
     virtual void discoverBasicBlocks(Partitioner&);
 
+    /** Decode instructions for undiscovered basic blocks in parallel.
+     *
+     *  If the engine's "undiscovered" work list has at least as many addresses as the @ref DisassemblerSettings
+     *  "prefetchBatchSize" setting then the instructions for those blocks are decoded speculatively in parallel and cached in
+     *  the partitioner's instruction provider.  Returns the number of work list addresses that were prefetched, or zero if
+     *  the work list was too small. This is called by @ref discoverBasicBlocks when placeholder prefetching is enabled. */
+    virtual size_t prefetchUndiscovered(Partitioner&);
+
     /** Scan read-only data to find function pointers.
      *
      *  Scans read-only data beginning at the specified address in order to find pointers to code, and makes a new function at
@@ -918,7 +970,10 @@ public:
      *
      *  Runs each analysis over all functions to ensure that results are cached.  This should typically be done after functions
      *  are discovered and before the final AST is generated, otherwise the AST will not contain cached results for functions
-     *  and blocks for which an analysis was not performed. */
+     *  and blocks for which an analysis was not performed.  The per-function analyses run together in a single parallel pass
+     *  over the function call graph (see @ref Partitioner::allFunctionAnalyses) using the number of threads specified by the
+     *  @ref PartitionerSettings::postAnalysisThreads setting, and the time spent in each analysis is reported on the INFO
+     *  stream. */
     virtual void updateAnalysisResults(Partitioner&);
 
 
@@ -347,6 +347,7 @@ public:
 
 private:
     friend class Partitioner;
+    friend class IndexedRba;
     void freeze() { isFrozen_ = true; }
     void thaw() { isFrozen_ = false; }
 };
@@ -0,0 +1,231 @@
+#ifndef ROSE_Partitioner2_IndexedRba_H
+#define ROSE_Partitioner2_IndexedRba_H
+
+#include <Partitioner2/BasicBlock.h>
+#include <Partitioner2/BasicTypes.h>
+#include <Partitioner2/DataBlock.h>
+#include <Partitioner2/Function.h>
+#include <Partitioner2/FunctionCallGraph.h>
+#include <MemoryMap.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <Sawyer/Map.h>
+#include <Sawyer/SharedObject.h>
+#include <Sawyer/SharedPointer.h>
+#include <vector>
+
+namespace Rose {
+namespace BinaryAnalysis {
+namespace Partitioner2 {
+
+/** Indexed, lazily loaded partitioner state file.
+ *
+ *  A state file written by @ref Engine::savePartitioner is a single Boost archive that must be read from start to finish,
+ *  materializing every instruction, basic block, and function before any of them can be used.  That can take minutes for a
+ *  large specimen even when the tool only needs a list of function names.  This class provides an alternative RBA file format
+ *  that is designed to be opened instantly and read on demand.
+ *
+ *  The file consists of a small header followed by independently serialized records: one record per function, one per basic
+ *  block (which includes the block's instructions), one for the memory map, and one for the partitioner's disassembler and
+ *  settings.  The header points to sorted index tables that map function entry addresses and basic block starting addresses
+ *  to the records, and instruction addresses to the position of the containing block in the basic block index, and to a
+ *  table describing the edges of the control flow graph.  Opening a file merely maps it into memory and validates the
+ *  header; a record is decoded the first time it's requested and the result is cached, so a tool touches only those parts of
+ *  the file that it actually uses.  An instruction is obtained by decoding the basic block that contains it.
+ *
+ *  The objects returned by the query methods are read-only snapshots of the partitioner's objects; they are not attached to
+ *  any partitioner. A complete partitioner can be rebuilt from the file with @ref partitioner, which is also what @ref
+ *  Engine::loadPartitioner does when it's given an indexed RBA file, and @ref Engine::savePartitioner writes this format
+ *  when the engine's @c savingIndexedRba setting is enabled (the @c --indexed-rba command-line switch). Records are written
+ *  in the host's native byte order, and a file written on a host with a different byte order is rejected.
+ *
+ *  Example usage:
+ *
+ * @code
+ *  // Save
+ *  P2::IndexedRba::save(partitioner, "specimen.rba");
+ *
+ *  // Later, in another tool
+ *  P2::IndexedRba::Ptr rba = P2::IndexedRba::instance("specimen.rba");
+ *  BOOST_FOREACH (rose_addr_t va, rba->functionAddresses())
+ *      std::cout <<rba->function(va)->printableName() <<"\n";
+ * @endcode
+ *
+ *  All methods are thread safe. */
+class IndexedRba: public Sawyer::SharedObject, private boost::noncopyable {
+public:
+    /** Reference counting pointer for indexed RBA files. */
+    typedef Sawyer::SharedPointer<IndexedRba> Ptr;
+
+    /** Control flow graph edge.
+     *
+     *  Edges are stored only for those source vertices that are basic blocks or basic block placeholders, identified by their
+     *  starting addresses. */
+    struct CfgEdge {
+        rose_addr_t sourceVa;                           /**< Starting address of the source basic block. */
+        rose_addr_t targetVa;                           /**< Starting address of the target, or zero if not a basic block. */
+        VertexType targetType;                          /**< Type of the target vertex. */
+        EdgeType type;                                  /**< Type of the edge. */
+        Confidence confidence;                          /**< Confidence in the edge. */
+
+        CfgEdge()
+            : sourceVa(0), targetVa(0), targetType(V_BASIC_BLOCK), type(E_NORMAL), confidence(ASSUMED) {}
+    };
+
+    /** Statistics about decoding. */
+    struct Stats {
+        size_t nFunctionsDecoded;                       /**< Number of function records decoded. */
+        size_t nBasicBlocksDecoded;                     /**< Number of basic block records decoded. */
+        size_t nBytesDecoded;                           /**< Total size of all records decoded. */
+
+        Stats()
+            : nFunctionsDecoded(0), nBasicBlocksDecoded(0), nBytesDecoded(0) {}
+    };
+
+    // Layouts of the index and edge tables in the file; intentionally undocumented.
+    struct IndexEntry;
+    struct InsnIndexEntry;
+    struct EdgeRecord;
+
+private:
+    mutable boost::mutex mutex_;                        // protects all following data members
+    boost::filesystem::path fileName_;
+    int fd_;                                            // open file descriptor
+    const uint8_t *map_;                                // read-only mapping of the whole file
+    size_t mapSize_;                                    // number of bytes mapped
+    const IndexEntry *functionIndex_;                   // function records sorted by entry address
+    size_t nFunctions_;
+    const IndexEntry *bblockIndex_;                     // basic block records sorted by starting address
+    size_t nBasicBlocks_;
+    const InsnIndexEntry *insnIndex_;                   // containing basic blocks sorted by instruction address
+    size_t nInstructions_;
+    const EdgeRecord *edges_;                           // CFG edges sorted by source address
+    size_t nEdges_;
+    uint64_t memoryMapOffset_, memoryMapSize_;          // location of the memory map record
+    uint64_t partitionerOffset_, partitionerSize_;      // location of the disassembler and partitioner settings record
+    Sawyer::Container::Map<rose_addr_t, Function::Ptr> functions_; // functions decoded so far
+    std::vector<BasicBlock::Ptr> bblocks_;              // basic blocks decoded so far, parallel to the basic block index
+    MemoryMap::Ptr memoryMap_;                          // memory map if decoded
+    Stats stats_;
+
+protected:
+    // Use instance() instead.
+    explicit IndexedRba(const boost::filesystem::path&);
+
+public:
+    ~IndexedRba();
+
+    /** Save a partitioner to an indexed RBA file.
+     *
+     *  Writes the functions, basic blocks, instructions, control flow graph edges, and memory map of the partitioner to the
+     *  specified file, which is created or truncated. Throws an @ref Exception if the file cannot be written.
+     *
+     *  Thread safety: This method is not thread safe with respect to other threads modifying the partitioner or the
+     *  instruction ASTs, since it temporarily clears the parent pointers of instructions while writing them. */
+    static void save(const Partitioner&, const boost::filesystem::path &fileName);
+
+    /** Open an indexed RBA file.
+     *
+     *  Maps the file into memory and checks its header. Nothing else is read until it's requested. Throws an @ref Exception if
+     *  the file cannot be opened or is not an indexed RBA file. */
+    static Ptr instance(const boost::filesystem::path &fileName);
+
+    /** Test whether a file is an indexed RBA file.
+     *
+     *  Returns true if the file exists and starts with the magic number of an indexed RBA file. */
+    static bool isIndexedRba(const boost::filesystem::path &fileName);
+
+    /** Name of the file. */
+    const boost::filesystem::path& fileName() const { return fileName_; }
+
+    /** Number of functions, basic blocks, and instructions in the file.
+     *
+     *  These come from the indexes and don't require any records to be decoded.
+     *
+     * @{ */
+    size_t nFunctions() const { return nFunctions_; }
+    size_t nBasicBlocks() const { return nBasicBlocks_; }
+    size_t nInstructions() const { return nInstructions_; }
+    /** @} */
+
+    /** Addresses of all functions and basic blocks.
+     *
+     *  Returns the function entry addresses or basic block starting addresses in ascending order without decoding any records.
+     *
+     * @{ */
+    std::vector<rose_addr_t> functionAddresses() const;
+    std::vector<rose_addr_t> basicBlockAddresses() const;
+    /** @} */
+
+    /** Function with the specified entry address.
+     *
+     *  Decodes the function record the first time it's requested. Returns null if there is no such function. */
+    Function::Ptr function(rose_addr_t entryVa);
+
+    /** Basic block with the specified starting address.
+     *
+     *  Decodes the basic block record, including its instructions, the first time it's requested. Returns null if there is no
+     *  such basic block. */
+    BasicBlock::Ptr basicBlock(rose_addr_t startVa);
+
+    /** Basic block containing the specified instruction.
+     *
+     *  Returns null if no basic block has an instruction starting at the specified address. */
+    BasicBlock::Ptr basicBlockContaining(rose_addr_t insnVa);
+
+    /** Instruction at the specified address.
+     *
+     *  Decodes the basic block that contains the instruction if necessary.  Returns null if the file has no instruction at
+     *  the specified address. */
+    SgAsmInstruction* instruction(rose_addr_t va);
+
+    /** Control flow graph edges.
+     *
+     *  Returns the edges whose source is the basic block (or placeholder) with the specified starting address, or all edges.
+     *  No records are decoded.
+     *
+     * @{ */
+    std::vector<CfgEdge> cfgEdges(rose_addr_t sourceVa) const;
+    std::vector<CfgEdge> cfgEdges() const;
+    /** @} */
+
+    /** Function call graph.
+     *
+     *  Builds the same function call graph as @ref Partitioner::functionCallGraph by decoding all the function records and
+     *  reading the control flow graph edges. No basic block records are decoded. */
+    FunctionCallGraph functionCallGraph(AllowParallelEdges::Type allowParallelEdges = AllowParallelEdges::NO);
+
+    /** Memory map.
+     *
+     *  Decodes the memory map the first time it's requested. */
+    MemoryMap::Ptr memoryMap();
+
+    /** Rebuild the partitioner.
+     *
+     *  Decodes every record in the file and returns a new partitioner that has the saved disassembler, memory map, and
+     *  settings, and to which all the saved basic blocks and functions are attached.  The control flow graph is recomputed from
+     *  the basic blocks' cached successors in the same way as when the blocks were originally attached.  The partitioner owns
+     *  its own copies of everything; none of them are shared with the snapshots returned by the query methods. Each call
+     *  returns a new partitioner. */
+    Partitioner partitioner();
+
+    /** Decoding statistics. */
+    Stats statistics() const;
+
+private:
+    void unmapNS();
+    void checkRecord(uint64_t offset, uint64_t size) const;
+    Function::Ptr functionNS(rose_addr_t entryVa);
+    BasicBlock::Ptr basicBlockNS(size_t bblockOrdinal);
+    MemoryMap::Ptr memoryMapNS();
+    static void shareDataBlocks(std::vector<DataBlock::Ptr> &dblocks /*in,out*/, std::vector<DataBlock::Ptr> &shared /*in,out*/);
+    std::vector<CfgEdge> cfgEdgesNS(const EdgeRecord *begin, const EdgeRecord *end) const;
+};
+
+} // namespace
+} // namespace
+} // namespace
+
+#endif
@@ -6,6 +6,7 @@
 #include "AstSerialization.h"
 
 #include <boost/serialization/access.hpp>
+#include <boost/unordered_set.hpp>
 #include <Sawyer/Assert.h>
 #include <Sawyer/HashMap.h>
 #include <Sawyer/SharedPointer.h>
@@ -33,11 +34,30 @@ public:
     /** Mapping from address to instruction. */
     typedef Sawyer::Container::HashMap<rose_addr_t, SgAsmInstruction*> InsnMap;
 
+    /** Instruction cache statistics.
+     *
+     *  These counters describe how effective the instruction cache is, and in particular how much of the serial lookup work
+     *  was satisfied by instructions that were decoded ahead of time by one of the @ref prefetch methods. */
+    struct Stats {
+        size_t nHits;                                   /**< Lookups satisfied by the cache. */
+        size_t nMisses;                                 /**< Lookups that needed to call the disassembler serially. */
+        size_t nPrefetched;                             /**< Instructions inserted into the cache by prefetching. */
+        size_t nPrefetchHits;                           /**< Distinct prefetched instructions that were later looked up. */
+        size_t nPrefetchDuplicates;                     /**< Prefetched instructions discarded because already cached. */
+        double prefetchTime;                            /**< Elapsed seconds spent prefetching. */
+        // Remember to add all data members to resetStatistics()
+
+        Stats()
+            : nHits(0), nMisses(0), nPrefetched(0), nPrefetchHits(0), nPrefetchDuplicates(0), prefetchTime(0.0) {}
+    };
+
 private:
     Disassembler *disassembler_;
     MemoryMap::Ptr memMap_;
     mutable InsnMap insnMap_;                           // this is a cache
     bool useDisassembler_;
+    mutable Stats stats_;                               // cache statistics (not serialized)
+    mutable boost::unordered_set<rose_addr_t> prefetchedUnused_; // prefetched addresses not yet looked up
 
 #ifdef ROSE_HAVE_BOOST_SERIALIZATION_LIB
 private:
@@ -131,6 +151,34 @@ public:
      *  are not executable. */
     SgAsmInstruction* operator[](rose_addr_t va) const;
 
+    /** Speculatively decode instructions in parallel.
+     *
+     *  These methods populate the instruction cache ahead of time so that later calls to @ref operator[] (such as those made
+     *  by the partitioner while it serially builds the control flow graph) are satisfied from the cache rather than calling
+     *  the disassembler one address at a time.  The work is split into tasks that are distributed across up to @p nThreads
+     *  worker threads (zero means use the hardware concurrency) and each worker decodes with its own clone of the
+     *  disassembler.  Addresses that are already cached are not decoded again.  These methods return only after all workers
+     *  have finished, and they return the number of instructions that were added to the cache.
+     *
+     *  The interval version does a linear sweep of the executable addresses in the specified interval by splitting it into
+     *  chunks of approximately @p chunkSize bytes.  Each chunk is decoded from its first address, advancing by the size of
+     *  each decoded instruction (or by one byte for unknown instructions).  Instruction sets with variable-length encodings
+     *  resynchronize quickly, so the few instructions near chunk boundaries that are decoded out of phase are merely wasted
+     *  cache entries.  The version with no interval argument sweeps every executable segment of the memory map.
+     *
+     *  The address list version is intended for worklists such as the partitioner's undiscovered basic block placeholders.
+     *  Starting at each address it decodes consecutive instructions until it reaches one that terminates a basic block or it
+     *  has decoded @p maxInsns instructions.
+     *
+     *  These methods are a no-op if the disassembler is disabled. They are not thread safe with respect to other methods of
+     *  this object: no other thread may access this instruction provider while prefetching is in progress.
+     *
+     * @{ */
+    size_t prefetch(size_t nThreads, size_t chunkSize = 65536);
+    size_t prefetch(const AddressInterval&, size_t nThreads, size_t chunkSize = 65536);
+    size_t prefetch(const std::vector<rose_addr_t> &startVas, size_t nThreads, size_t maxInsns = 64);
+    /** @} */
+
     /** Insert an instruction into the cache.
      *
      *  This instruction provider saves a pointer to the instruction without taking ownership.  If an instruction already
@@ -183,8 +231,28 @@ public:
      *  only be used to call its virtual constructor to create a valid dispatcher. */
     InstructionSemantics2::BaseSemantics::DispatcherPtr dispatcher() const { return disassembler_->dispatcher(); }
 
+    /** Cache statistics.
+     *
+     *  Returns the hit, miss, and prefetch counters that have been accumulated since this object was created or since the
+     *  last call to @ref resetStatistics.
+     *
+     * @{ */
+    const Stats& statistics() const { return stats_; }
+    void resetStatistics();
+    /** @} */
+
     /** Print some partitioner performance statistics. */
     void showStatistics() const;
+
+private:
+    friend class InstructionPrefetcher;
+
+    // Decode one instruction with the specified disassembler, producing an "unknown" instruction if the bytes at the specified
+    // address cannot be decoded. Returns null if the address is not executable.
+    SgAsmInstruction* decode(Disassembler*, rose_addr_t va) const;
+
+    // Runs the prefetch tasks in parallel and inserts the results into the cache.
+    size_t prefetchTasks(const std::vector<AddressInterval> &where, bool stopAtBlockEnd, size_t maxInsns, size_t nThreads);
 };
 
 } // namespace
@@ -627,6 +627,16 @@ public:
     /** Returns the address usage map for a single function. */
     AddressUsageMap aum(const Function::Ptr&) const /*final*/;
 
+    /** Optimize the address usage map for queries.
+     *
+     *  Builds a compact index for the address usage map so that queries such as @ref functionsOverlapping and @ref
+     *  basicBlockContainingInstruction run faster. The index is discarded automatically the next time the partitioner
+     *  modifies the map. This is called by @ref Engine::runPartitioner when partitioning is complete. See @ref
+     *  AddressUsageMap::freeze.
+     *
+     *  Thread safety: Not thread safe. */
+    void freezeAum() /*final*/ { aum_.freeze(); }
+
     /** Entities that exist at a particular address.
      *
      *  Returns a vector of @ref AddressUser objects that describe instructions, basic blocks, data blocks, and functions that
@@ -2057,6 +2067,50 @@ public:
     void forgetFunctionIsNoop(const Function::Ptr&) const /*final*/;
     /** @} */
 
+    /** Which per-function analyses to run in @ref allFunctionAnalyses. */
+    struct FunctionAnalyses {
+        bool noop;                                      /**< Run @ref functionIsNoop. */
+        bool mayReturn;                                 /**< Run @ref functionOptionalMayReturn. */
+        bool stackDelta;                                /**< Run @ref functionStackDelta. */
+        bool callingConvention;                         /**< Run @ref functionCallingConvention. */
+        CallingConvention::Definition::Ptr dfltCc;      /**< Default calling convention passed to the calling-convention analysis. */
+        size_t nThreads;                                /**< Number of worker threads, or zero for the hardware concurrency. */
+
+        FunctionAnalyses()
+            : noop(false), mayReturn(false), stackDelta(false), callingConvention(false), nThreads(1) {}
+    };
+
+    /** Time spent in each analysis by @ref allFunctionAnalyses.
+     *
+     *  Times are in seconds summed across all worker threads, so they can exceed the elapsed time when more than one thread
+     *  is used. */
+    struct FunctionAnalysisTimes {
+        double noop;                                    /**< Time spent in function no-op analysis. */
+        double mayReturn;                               /**< Time spent in function may-return analysis. */
+        double stackDelta;                              /**< Time spent in function stack-delta analysis. */
+        double callingConvention;                       /**< Time spent in function calling-convention analysis. */
+
+        FunctionAnalysisTimes()
+            : noop(0.0), mayReturn(0.0), stackDelta(0.0), callingConvention(0.0) {}
+    };
+
+    /** Run several function analyses in one pass over the call graph.
+     *
+     *  Each function is analyzed by each of the selected analyses in the order no-op, may-return, stack-delta, and
+     *  calling-convention, and the functions are scheduled across worker threads so that a function is analyzed only after
+     *  all its callees (except those in the same recursion cycle) have been analyzed.  This is equivalent to calling @ref
+     *  allFunctionIsNoop, @ref allFunctionMayReturn, @ref allFunctionStackDelta, and @ref allFunctionCallingConvention in
+     *  turn, except the analyses overlap one another and there is only one synchronization point instead of four.
+     *
+     *  The may-return analysis follows the CFG into called functions and caches its results in basic blocks that might be
+     *  shared between functions, therefore it runs in only one thread at a time although it can overlap with the other
+     *  analyses.  Functions that already have results for an analysis are not reanalyzed by that analysis.
+     *
+     *  Returns the time spent in each analysis.
+     *
+     *  Thread safety: Not thread safe. */
+    FunctionAnalysisTimes allFunctionAnalyses(const FunctionAnalyses&) const /*final*/;
+
     /** Find constants in function using data-flow.
      *
      *  This function runs a simple data-flow operation on the specified function and examines all states to obtain a set
@@ -2,3 +2,7 @@
 // DQ (5/27/2007): External API used by Cxx_Grammar.C and Rewrite Mechanism
 int buildAstMergeCommandFile ( SgProject* project );
 int AstMergeSupport ( SgProject* project );
+
+// Reads the ASTs written by AST_FILE_IO::writeASTToFile() to the named files, moves their files into the first
+// project and merges the shared declarations and types. Returns the project holding all files.
+SgProject* mergeAstFiles ( const std::vector<std::string> & astFileNames );
@@ -98,6 +98,10 @@
 #include <algorithm>
 #include <fstream>
 
+// Used by the IR node memory pools' per-thread allocation caches
+#include <Sawyer/Sawyer.h>
+#include <boost/thread/tss.hpp>
+
 // DQ (8/25/2014): Added logic to isTemplateDeclaration(a_routine_ptr) to force isTemplateDeclaration 
 // in ROSE/EDG connection to be false where the topScopeStack() is a template class instantaition scope.
 #define ENFORCE_NO_FUNCTION_TEMPLATE_DECLARATIONS_IN_TEMPLATE_CLASS_INSTANTIATIONS 0
@@ -302,6 +306,10 @@
    #error "DEFAULT_CLASS_ALLOCATION_POOL_SIZE must be greater than zero!"
 #endif
 
+// Number of free IR nodes that a thread moves from the shared free list of a memory pool to its own allocation cache at once.
+// Allocating and deleting nodes of a type only locks that type's memory pool when the thread's cache is empty (or full).
+#define DEFAULT_CLASS_ALLOCATION_CACHE_SIZE 64
+
 // DQ (3/7/2010): This is no longer used (for several years) and we use an STL based implementation.
 // #define MAX_NUMBER_OF_MEMORY_BLOCKS        1000
 
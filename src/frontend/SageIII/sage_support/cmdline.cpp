@@ -338,6 +338,7 @@ CommandlineProcessing::isOptionTakingSecondParameter( string argument )
           argument == "-rose:includeFile" ||
           argument == "-rose:excludeFile" ||
           argument == "-rose:astMergeCommandFile" ||
+          argument == "-rose:parallelFrontend" ||
           argument == "-rose:projectSpecificDatabaseFile" ||
 
           // TOO1 (2/13/2014): Starting to refactor CLI handling into separate namespaces
@@ -3218,6 +3219,9 @@ SgFile::usage ( int status )
 "     -rose:astMergeCommandFile FILE\n"
 "                             filename where compiler command lines are stored\n"
 "                             for later processing (using AST merge mechanism)\n"
+"     -rose:parallelFrontend N\n"
+"                             parse the source files in up to N separate processes\n"
+"                             and merge their ASTs (using AST merge mechanism)\n"
 "     -rose:projectSpecificDatabaseFile FILE\n"
 "                             filename where a database of all files used in a project are stored\n"
 "                             for producing unique trace ids and retrieving the reverse mapping from trace to files"
@@ -5441,6 +5445,7 @@ SgFile::stripRoseCommandLineOptions ( vector<string> & argv )
      optionCount = sla(argv, "-rose:", "($)", "(astMerge)",1);
      char* filename = NULL;
      optionCount = sla(argv, "-rose:", "($)^", "(astMergeCommandFile)",filename,1);
+     optionCount = sla(argv, "-rose:", "($)^", "(parallelFrontend)",&integerOption,1);
      optionCount = sla(argv, "-rose:", "($)^", "(projectSpecificDatabaseFile)",filename,1);
      optionCount = sla(argv, "-rose:", "($)^", "(compilationPerformanceFile)",filename,1);
 
@@ -6,11 +6,17 @@
 #include "RoseException.h"
 #include "SymbolicSemantics2.h"
 
+#include <boost/exception_ptr.hpp>
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 #include <list>
 #include <Sawyer/GraphTraversal.h>
 #include <Sawyer/DistinctList.h>
+#include <Sawyer/Stopwatch.h>
+#include <Sawyer/ThreadWorkers.h>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -104,6 +110,20 @@ public:
         explicit NotConverging(const std::string &s): Exception(s) {}
     };
 
+    /** Order in which an engine visits the vertices on its work list.
+     *
+     *  See @ref Engine::workListOrder. */
+    enum WorkListOrder {
+        WORKLIST_FIFO,                                  /**< Visit vertices in the order they were added to the work list. */
+        WORKLIST_RPO,                                   /**< Visit the pending vertex that's earliest in reverse post-order. */
+        WORKLIST_WTO                                    /**< Visit the pending vertex that's earliest in weak topological order. */
+    };
+
+    /** Successor vertex IDs indexed by vertex ID.
+     *
+     *  This is the graph representation used by the vertex ordering functions. */
+    typedef std::vector<std::vector<size_t> > SuccessorLists;
+
 private:
     InstructionSemantics2::BaseSemantics::RiscOperatorsPtr userOps_; // operators (and state) provided by the user
     InstructionSemantics2::DataFlowSemantics::RiscOperatorsPtr dfOps_; // data-flow operators (which point to user ops)
@@ -204,6 +224,30 @@ public:
      *  determined by calling AbstractLocation::mustAlias. The variables are returned in no particular order. */
     VariableList getUniqueVariables(const VertexFlowGraphs&);
 
+    /** Vertices in reverse post-order.
+     *
+     *  Returns every vertex ID of the graph exactly once. The depth-first traversals start at the @p roots, in the order
+     *  given, and then at each vertex not yet visited in order of increasing ID. In the absence of back edges every vertex
+     *  appears after all its predecessors. */
+    static std::vector<size_t> reversePostOrder(const SuccessorLists&, const std::vector<size_t> &roots);
+
+    /** Vertices in weak topological order.
+     *
+     *  Returns every vertex ID of the graph exactly once, ordered according to Bourdoncle's hierarchical decomposition: the
+     *  strongly connected components are listed in topological order, each component starting with its head (the vertex
+     *  through which the depth-first traversal entered the component) followed by the weak topological order of the rest of
+     *  the component.  Inner loops therefore appear as contiguous runs nested within the run of their enclosing loop. Roots
+     *  are handled as for @ref reversePostOrder. */
+    static std::vector<size_t> weakTopologicalOrder(const SuccessorLists&, const std::vector<size_t> &roots);
+
+    /** Strongly connected components.
+     *
+     *  Returns the strongly connected components of the graph in topological order. The first vertex of each component is its
+     *  head as defined for @ref weakTopologicalOrder. Every vertex belongs to exactly one component. Roots are handled as for
+     *  @ref reversePostOrder. */
+    static std::vector<std::vector<size_t> > stronglyConnectedComponents(const SuccessorLists&,
+                                                                          const std::vector<size_t> &roots);
+
     /** Basic merge operation for instruction semantics.
      *
      *  This merge operator is for data-flow that uses an instruction semantics state. */
@@ -297,7 +341,18 @@ public:
      *  InstructionSemantics2::BaseSemantics::State::merge "merge" method.
      *
      *  The control flow graph and transfer function are specified in the engine's constructor.  The starting CFG vertex and
-     *  its initial state are supplied when the engine starts to run. */
+     *  its initial state are supplied when the engine starts to run.
+     *
+     *  The number of iterations needed to reach a fixed point depends on the order in which pending vertices are visited.  By
+     *  default they're visited in the order they were added to the work list, but the @ref workListOrder property can select
+     *  reverse post-order or weak topological order instead, in which case the engine always visits the pending vertex that
+     *  comes first in that order.  Both orders visit a vertex after its forward predecessors, and weak topological order
+     *  additionally stabilizes each inner loop before continuing with the enclosing loop, which usually reduces the number of
+     *  iterations for deeply nested loops.  The order is computed from the control flow graph when the first iteration runs,
+     *  using the vertices on the work list at that time as the roots.
+     *
+     *  The @ref runToFixedPointInParallel method solves independent strongly connected components of the control flow graph
+     *  concurrently. See its documentation for the requirements it places on the functors. */
     template<class CFG, class State, class TransferFunction, class MergeFunction,
              class PathFeasibility = PathAlwaysFeasible<CFG, State> >
     class Engine {
@@ -311,10 +366,37 @@ public:
         VertexStates incomingState_;                    // incoming data-flow state per CFG vertex ID
         VertexStates outgoingState_;                    // outgoing data-flow state per CFG vertex ID
         typedef Sawyer::Container::DistinctList<size_t> WorkList;
-        WorkList workList_;                             // CFG vertex IDs to be visited, last in first out w/out duplicates
+        WorkList workList_;                             // CFG vertex IDs to be visited, first in first out w/out duplicates
         size_t maxIterations_;                          // max number of iterations to allow
         size_t nIterations_;                            // number of iterations since last reset
         PathFeasibility isFeasible_;                    // predicate to test path feasibility
+        DataFlow::WorkListOrder workListOrder_;         // order in which to visit pending vertices
+        std::vector<size_t> rank_;                      // position of each vertex ID in the visiting order; empty if not computed
+        std::vector<size_t> rankedVertex_;              // vertex ID for each position in the visiting order
+        std::set<size_t> rankedWork_;                   // ranks of pending vertices when rank_ is not empty
+        double transferTime_;                           // seconds spent in the transfer function since last reset
+
+        // State shared by the threads of runToFixedPointInParallel
+        struct ParallelRun {
+            std::vector<std::vector<size_t> > components; // strongly connected components
+            std::vector<size_t> componentOf;            // component index per vertex ID
+            std::vector<char> pending;                  // vertices whose incoming state changed from another component
+            boost::mutex mutex;                         // protects pending, and the engine's statistics
+            boost::exception_ptr exception;             // first exception thrown by any thread
+        };
+
+        // Functor for Sawyer::workInParallel. Each task solves one strongly connected component.
+        struct ComponentWorker {
+            Engine *engine;
+            ParallelRun *run;
+
+            ComponentWorker(Engine *engine, ParallelRun *run)
+                : engine(engine), run(run) {}
+
+            void operator()(size_t componentIdx, size_t&) {
+                engine->solveComponent(*run, componentIdx);
+            }
+        };
 
     public:
         /** Constructor.
@@ -324,7 +406,8 @@ public:
          *  copied. */
         Engine(const CFG &cfg, TransferFunction &xfer, MergeFunction merge = MergeFunction(),
                PathFeasibility isFeasible = PathFeasibility())
-            : cfg_(cfg), xfer_(xfer), merge_(merge), maxIterations_(-1), nIterations_(0), isFeasible_(isFeasible) {}
+            : cfg_(cfg), xfer_(xfer), merge_(merge), maxIterations_(-1), nIterations_(0), isFeasible_(isFeasible),
+              workListOrder_(DataFlow::WORKLIST_FIFO), transferTime_(0.0) {}
 
         /** Data-flow control flow graph.
          *
@@ -342,7 +425,11 @@ public:
             outgoingState_.clear();
             outgoingState_.resize(cfg_.nVertices(), initialState);
             workList_.clear();
+            rank_.clear();
+            rankedVertex_.clear();
+            rankedWork_.clear();
             nIterations_ = 0;
+            transferTime_ = 0.0;
         }
 
         /** Max number of iterations to allow.
@@ -357,26 +444,55 @@ public:
 
         /** Number of iterations run.
          *
-         *  The number of times runOneIteration was called since the last reset. */
+         *  The number of times runOneIteration was called since the last reset. Each iteration runs the transfer function once,
+         *  so this is also the number of transfer function calls. */
         size_t nIterations() const { return nIterations_; }
-        
+
+        /** Time spent in the transfer function.
+         *
+         *  Total elapsed time in seconds for all transfer function calls since the last reset. When the engine runs in parallel
+         *  this is the sum over all threads and can therefore exceed the elapsed time of the run. */
+        double transferTime() const { return transferTime_; }
+
+        /** Order in which pending vertices are visited.
+         *
+         *  The default is @ref DataFlow::WORKLIST_FIFO, which visits vertices in the order they were added to the work list.
+         *  The other orders are computed from the control flow graph the next time an iteration runs. Changing the order does
+         *  not change the set of pending vertices.
+         *
+         * @{ */
+        DataFlow::WorkListOrder workListOrder() const { return workListOrder_; }
+        void workListOrder(DataFlow::WorkListOrder order) {
+            if (order != workListOrder_) {
+                BOOST_FOREACH (size_t rank, rankedWork_)
+                    workList_.pushBack(rankedVertex_[rank]);
+                rank_.clear();
+                rankedVertex_.clear();
+                rankedWork_.clear();
+                workListOrder_ = order;
+            }
+        }
+        /** @} */
+
         /** Runs one iteration.
          *
          *  Runs one iteration of data-flow analysis by consuming the first item on the work list.  Returns false if the
          *  work list is empty (before of after the iteration). */
         bool runOneIteration() {
             using namespace Diagnostics;
-            if (!workList_.isEmpty()) {
+            if (!isWorkListEmpty()) {
                 if (++nIterations_ > maxIterations_) {
                     throw NotConverging("data-flow max iterations reached"
                                         " (max=" + StringUtility::numberToString(maxIterations_) + ")");
                 }
-                size_t cfgVertexId = workList_.popFront();
+                size_t cfgVertexId = popWorkList();
                 if (mlog[DEBUG]) {
                     mlog[DEBUG] <<"runOneIteration: vertex #" <<cfgVertexId <<"\n";
                     mlog[DEBUG] <<"  remaining worklist is {";
                     BOOST_FOREACH (size_t id, workList_.items())
                         mlog[DEBUG] <<" " <<id;
+                    BOOST_FOREACH (size_t rank, rankedWork_)
+                        mlog[DEBUG] <<" " <<rankedVertex_[rank];
                     mlog[DEBUG] <<" }\n";
                 }
                 
@@ -389,7 +505,9 @@ public:
                                 <<StringUtility::prefixLines(xfer_.printState(state), "    ") <<"\n";
                 }
 
+                Sawyer::Stopwatch transferTimer;
                 state = outgoingState_[cfgVertexId] = xfer_(cfg_, cfgVertexId, state);
+                transferTime_ += transferTimer.stop();
                 if (mlog[DEBUG]) {
                     mlog[DEBUG] <<"  outgoing state for vertex #" <<cfgVertexId <<":\n"
                                 <<StringUtility::prefixLines(xfer_.printState(state), "    ") <<"\n";
@@ -410,19 +528,19 @@ public:
                                         <<StringUtility::prefixLines(xfer_.printState(incomingState_[nextVertexId]),
                                                                      "      ", false) <<"\n";
                         }
-                        workList_.pushBack(nextVertexId);
+                        pushWorkList(nextVertexId);
                     } else {
                         SAWYER_MESG(mlog[DEBUG]) <<"    merged with vertex #" <<nextVertexId <<" (no change)\n";
                     }
                 }
             }
-            return !workList_.isEmpty();
+            return !isWorkListEmpty();
         }
 
         /** Add a starting vertex. */
         void insertStartingVertex(size_t startVertexId, const State &initialState) {
             incomingState_[startVertexId] = initialState;
-            workList_.pushBack(startVertexId);
+            pushWorkList(startVertexId);
         }
 
         /** Run data-flow until it reaches a fixed point.
@@ -443,6 +561,73 @@ public:
             while (runOneIteration()) /*void*/;
         }
 
+        /** Run data-flow to a fixed point using multiple threads.
+         *
+         *  This is like @ref runToFixedPoint except the control flow graph is first partitioned into its strongly connected
+         *  components, and each component is solved to a fixed point by a single thread as soon as all the components that
+         *  have edges into it have been solved. Components that don't depend on each other, such as the two sides of an
+         *  if-then-else whose bodies contain loops, are therefore solved concurrently.  Within a component the vertices are
+         *  visited in weak topological order if that's the @ref workListOrder, otherwise reverse post-order.  The fixed point
+         *  reached is the same as for @ref runToFixedPoint although the number of iterations can differ.
+         *
+         *  The transfer function, merge function, and path feasibility predicate are called concurrently from multiple threads
+         *  and must therefore be thread safe. In particular, a merge function that temporarily changes the current state of
+         *  shared RISC operators (such as @ref SemanticsMerge) is not thread safe unless each thread's states are merged with
+         *  different operators.  Merges into vertices of other components are serialized, but merges within a component are
+         *  not.
+         *
+         *  If @p nThreads is zero then the system's hardware concurrency is used. If any thread throws an exception (including
+         *  @ref NotConverging) then the remaining components are abandoned, their pending vertices are left on the work list,
+         *  and the first exception is rethrown in the calling thread. */
+        void runToFixedPointInParallel(size_t nThreads) {
+            if (isWorkListEmpty())
+                return;
+            std::vector<size_t> roots;
+            while (!isWorkListEmpty())
+                roots.push_back(popWorkList());
+            DataFlow::SuccessorLists successors = successorLists();
+            if (rank_.empty())
+                computeRanks(successors, roots, workListOrder_ == DataFlow::WORKLIST_WTO ?
+                             DataFlow::WORKLIST_WTO : DataFlow::WORKLIST_RPO);
+
+            ParallelRun run;
+            run.components = DataFlow::stronglyConnectedComponents(successors, roots);
+            run.componentOf.resize(cfg_.nVertices());
+            run.pending.resize(cfg_.nVertices(), 0);
+            for (size_t i=0; i<run.components.size(); ++i) {
+                BOOST_FOREACH (size_t vertexId, run.components[i])
+                    run.componentOf[vertexId] = i;
+            }
+            BOOST_FOREACH (size_t vertexId, roots)
+                run.pending[vertexId] = 1;
+
+            // An edge from component A to component B means B must be solved before A.
+            Sawyer::Container::Graph<size_t> dependencies;
+            for (size_t i=0; i<run.components.size(); ++i)
+                dependencies.insertVertex(i);
+            std::set<std::pair<size_t, size_t> > dependencyEdges;
+            for (size_t source=0; source<successors.size(); ++source) {
+                BOOST_FOREACH (size_t target, successors[source]) {
+                    size_t a = run.componentOf[target], b = run.componentOf[source];
+                    if (a != b && dependencyEdges.insert(std::make_pair(a, b)).second)
+                        dependencies.insertEdge(dependencies.findVertex(a), dependencies.findVertex(b));
+                }
+            }
+
+            Sawyer::workInParallel(dependencies, nThreads, ComponentWorker(this, &run));
+
+            if (DataFlow::WORKLIST_FIFO == workListOrder_) {
+                rank_.clear();
+                rankedVertex_.clear();
+            }
+            for (size_t vertexId=0; vertexId<run.pending.size(); ++vertexId) {
+                if (run.pending[vertexId])
+                    pushWorkList(vertexId);
+            }
+            if (run.exception)
+                boost::rethrow_exception(run.exception);
+        }
+
         /** Return the incoming state for the specified CFG vertex.
          *
          *  This is a pointer to the incoming state for the vertex as of the latest data-flow iteration.  If the data-flow has
@@ -479,6 +664,125 @@ public:
         const VertexStates& getFinalStates() const {
             return outgoingState_;
         }
+
+    private:
+        bool isWorkListEmpty() const {
+            return workList_.isEmpty() && rankedWork_.empty();
+        }
+
+        void pushWorkList(size_t vertexId) {
+            if (rank_.empty()) {
+                workList_.pushBack(vertexId);
+            } else {
+                rankedWork_.insert(rank_[vertexId]);
+            }
+        }
+
+        // Remove and return the next vertex to visit. Computes the visiting order if necessary.
+        size_t popWorkList() {
+            ASSERT_forbid(isWorkListEmpty());
+            if (rank_.empty() && workListOrder_ != DataFlow::WORKLIST_FIFO) {
+                std::vector<size_t> roots(workList_.items().begin(), workList_.items().end());
+                computeRanks(successorLists(), roots, workListOrder_);
+            }
+            if (rank_.empty())
+                return workList_.popFront();
+            size_t vertexId = rankedVertex_[*rankedWork_.begin()];
+            rankedWork_.erase(rankedWork_.begin());
+            return vertexId;
+        }
+
+        DataFlow::SuccessorLists successorLists() const {
+            DataFlow::SuccessorLists successors(cfg_.nVertices());
+            BOOST_FOREACH (const typename CFG::Vertex &vertex, cfg_.vertices()) {
+                BOOST_FOREACH (const typename CFG::Edge &edge, vertex.outEdges())
+                    successors[vertex.id()].push_back(edge.target()->id());
+            }
+            return successors;
+        }
+
+        // Compute the visiting order and move the pending FIFO vertices to the ranked work list.
+        void computeRanks(const DataFlow::SuccessorLists &successors, const std::vector<size_t> &roots,
+                          DataFlow::WorkListOrder order) {
+            ASSERT_require(order != DataFlow::WORKLIST_FIFO);
+            rankedVertex_ = DataFlow::WORKLIST_WTO == order ?
+                            DataFlow::weakTopologicalOrder(successors, roots) :
+                            DataFlow::reversePostOrder(successors, roots);
+            rank_.resize(rankedVertex_.size());
+            for (size_t i=0; i<rankedVertex_.size(); ++i)
+                rank_[rankedVertex_[i]] = i;
+            while (!workList_.isEmpty())
+                rankedWork_.insert(rank_[workList_.popFront()]);
+        }
+
+        // Solve one strongly connected component to a fixed point. Called by the worker threads of runToFixedPointInParallel
+        // after all components with edges into this component have been solved, therefore only this thread accesses the
+        // states of this component's vertices except for serialized merges from the other components.
+        void solveComponent(ParallelRun &run, size_t componentIdx) {
+            try {
+                std::set<size_t> work;                  // ranks of this component's pending vertices
+                {
+                    boost::lock_guard<boost::mutex> lock(run.mutex);
+                    if (run.exception)
+                        return;
+                    BOOST_FOREACH (size_t vertexId, run.components[componentIdx]) {
+                        if (run.pending[vertexId]) {
+                            run.pending[vertexId] = 0;
+                            work.insert(rank_[vertexId]);
+                        }
+                    }
+                }
+
+                double elapsed = 0.0;
+                while (!work.empty()) {
+                    size_t cfgVertexId = rankedVertex_[*work.begin()];
+                    work.erase(work.begin());
+                    {
+                        boost::lock_guard<boost::mutex> lock(run.mutex);
+                        if (!run.exception && ++nIterations_ > maxIterations_) {
+                            run.exception = boost::copy_exception(NotConverging("data-flow max iterations reached"
+                                                                                " (max=" +
+                                                                                StringUtility::numberToString(maxIterations_) +
+                                                                                ")"));
+                        }
+                        if (run.exception) {
+                            // Leave this component's remaining work for the caller.
+                            run.pending[cfgVertexId] = 1;
+                            BOOST_FOREACH (size_t rank, work)
+                                run.pending[rankedVertex_[rank]] = 1;
+                            transferTime_ += elapsed;
+                            return;
+                        }
+                    }
+
+                    Sawyer::Stopwatch transferTimer;
+                    State state = outgoingState_[cfgVertexId] = xfer_(cfg_, cfgVertexId, incomingState_[cfgVertexId]);
+                    elapsed += transferTimer.stop();
+
+                    typename CFG::ConstVertexIterator vertex = cfg_.findVertex(cfgVertexId);
+                    BOOST_FOREACH (const typename CFG::Edge &edge, vertex->outEdges()) {
+                        size_t nextVertexId = edge.target()->id();
+                        if (!isFeasible_(cfg_, edge, state))
+                            continue;
+                        if (run.componentOf[nextVertexId] == componentIdx) {
+                            if (merge_(incomingState_[nextVertexId], state))
+                                work.insert(rank_[nextVertexId]);
+                        } else {
+                            boost::lock_guard<boost::mutex> lock(run.mutex);
+                            if (merge_(incomingState_[nextVertexId], state))
+                                run.pending[nextVertexId] = 1;
+                        }
+                    }
+                }
+
+                boost::lock_guard<boost::mutex> lock(run.mutex);
+                transferTime_ += elapsed;
+            } catch (...) {
+                boost::lock_guard<boost::mutex> lock(run.mutex);
+                if (!run.exception)
+                    run.exception = boost::current_exception();
+            }
+        }
     };
 };
 
@@ -81,12 +81,14 @@ public:
         std::vector<rose_addr_t> summarizeFunctions;    /**< Functions to always summarize. */
         bool nonAddressIsFeasible;                      /**< Indeterminate/undiscovered vertices are feasible? */
         std::string solverName;                         /**< Type of SMT solver. */
+        bool incrementalSmt;                            /**< Keep executable SMT solvers running between path extensions. */
         SemanticMemoryParadigm memoryParadigm;          /**< Type of memory state when there's a choice to be made. */
         bool processFinalVertex;                        /**< Whether to process the last vertex of the path. */
         bool ignoreSemanticFailure;                     /**< Whether to ignore instructions with no semantic info. */
         double kCycleCoefficient;                       /**< Coefficient for adjusting maxPathLengh during CFG cycles. */
         EdgeVisitOrder edgeVisitOrder;                  /**< Order in which to visit edges. */
         bool trackingCodeCoverage;                      /**< If set, track which block addresses are reached. */
+        size_t nThreads;                                /**< Threads for depth-first search; zero means use the hardware. */
 
         // Null dereferences
         struct NullDeref {
@@ -103,9 +105,9 @@ public:
         /** Default settings. */
         Settings()
             : searchMode(SEARCH_SINGLE_DFS), maxVertexVisit((size_t)-1), maxPathLength(200), maxCallDepth((size_t)-1),
-              maxRecursionDepth((size_t)-1), nonAddressIsFeasible(true), solverName("best"),
+              maxRecursionDepth((size_t)-1), nonAddressIsFeasible(true), solverName("best"), incrementalSmt(false),
               memoryParadigm(LIST_BASED_MEMORY), processFinalVertex(false), ignoreSemanticFailure(false),
-              kCycleCoefficient(0.0), edgeVisitOrder(VISIT_NATURAL), trackingCodeCoverage(true) {}
+              kCycleCoefficient(0.0), edgeVisitOrder(VISIT_NATURAL), trackingCodeCoverage(true), nThreads(1) {}
     };
 
     /** Diagnostic output. */
@@ -140,7 +142,11 @@ public:
 
     /** Path searching functor.
      *
-     *  This is the base class for user-defined functors called when searching for feasible paths. */
+     *  This is the base class for user-defined functors called when searching for feasible paths.
+     *
+     *  When the search uses more than one thread (see @ref Settings::nThreads) the calls to these methods are serialized, so
+     *  a processor need not be thread safe. However, the calls for different paths are interleaved in no particular order,
+     *  and the @c cpu and @c solver arguments are different objects in different threads. */
     class PathProcessor {
     public:
         enum Action {
@@ -457,7 +463,15 @@ public:
     /** Find all feasible paths.
      *
      *  Searches for paths and calls the @p pathProcessor each time a feasible path is found. The space is explored using a
-     *  depth first search, and the search can be limited with various @ref settings. */
+     *  depth first search, and the search can be limited with various @ref settings.
+     *
+     *  If the @ref Settings::nThreads "nThreads" setting is more than one then the search tree is divided among that many
+     *  threads. Each thread has its own SMT solver and semantic states, and a thread that runs out of work is given an
+     *  unexplored part of some other thread's search tree.  The path limits apply to each path as they do for a single
+     *  thread, but the order in which paths are found is not deterministic, and neither is which path first reaches a call
+     *  site and thereby decides whether that call is inlined. Calls to the @p pathProcessor and to @ref functionSummarizer
+     *  initialization are serialized, but the other @ref FunctionSummarizer methods and the overridable processing functions
+     *  may be called concurrently. */
     void depthFirstSearch(PathProcessor &pathProcessor);
 
 
@@ -522,8 +536,28 @@ public:
     //                                  Private supporting functions
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 private:
+    // Depth-first search support, defined in the source file. SearchWork is a path whose final edge has not been checked yet
+    // together with the solver assertions for its earlier edges; SearchWorker is the per-thread state of a search; SearchPool
+    // is the state shared by all threads of a parallel search.
+    struct SearchWork;
+    struct SearchWorker;
+    struct SearchPool;
+
     static rose_addr_t virtualAddress(const Partitioner2::ControlFlowGraph::ConstVertexIterator &vertex);
 
+    // Augment the partitioner's register dictionary with the "path" pseudo-register if not done already.
+    void initRegisters(const Partitioner2::Partitioner&);
+
+    // Explore all paths that extend the work's path without backtracking into its prefix. Returns false if the path processor
+    // asked to stop searching.
+    bool searchSubtree(SearchWorker&, SearchWork&);
+
+    // Main function for each thread of a parallel search.
+    void searchThread(SearchPool&, PathProcessor&, size_t callId, size_t &graphId, AddressSet &reached /*in,out*/);
+
+    // Move the unexplored alternative edge nearest the start of the path to the pool of work for idle threads.
+    void shareWork(SearchPool&, Partitioner2::CfgPath&, const SmtSolver::Ptr&);
+
     void insertCallSummary(const Partitioner2::ControlFlowGraph::ConstVertexIterator &pathsCallSite,
                            const Partitioner2::ControlFlowGraph &cfg,
                            const Partitioner2::ControlFlowGraph::ConstEdgeIterator &cfgCallEdge);
@@ -563,7 +597,7 @@ private:
                          const std::vector<Expression> &userAssertions, bool atEndOfPath, SymbolicExprParser&);
 
     // Mark vertex as being reached
-    void markAsReached(const Partitioner2::ControlFlowGraph::ConstVertexIterator&);
+    void markAsReached(const Partitioner2::ControlFlowGraph::ConstVertexIterator&, AddressSet &reached /*in,out*/);
 };
 
 } // namespace
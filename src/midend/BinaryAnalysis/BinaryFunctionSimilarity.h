@@ -97,6 +97,35 @@ public:
     /** Square matrix representing distances. */
     typedef Matrix<double> DistanceMatrix;
 
+    /** Sparse matrix representing distances.
+     *
+     *  Each row is a list of column numbers and the distances at those columns. Missing columns are not candidates for being
+     *  paired with the row. */
+    typedef std::vector<std::vector<std::pair<size_t /*column*/, double /*distance*/> > > SparseDistanceMatrix;
+
+    /** Row that is not assigned to any column. See @ref findMinimumSparseAssignment. */
+    static const size_t NO_ASSIGNMENT = -1;
+
+    /** Settings for the nearest-function index.
+     *
+     *  See @ref buildIndex and @ref findNearest. */
+    struct IndexSettings {
+        /** Number of histogram bins used to summarize each ordered-list category in a function's signature. Changes take
+         *  effect the next time the index is built. */
+        size_t listBins;
+
+        /** Maximum number of functions stored in each leaf of the index. Changes take effect the next time the index is
+         *  built. */
+        size_t leafSize;
+
+        /** Number of candidate functions compared exactly for each requested neighbor. Larger values find more of the true
+         *  nearest functions at the cost of more comparisons. */
+        size_t oversampling;
+
+        IndexSettings()
+            : listBins(32), leafSize(16), oversampling(8) {}
+    };
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // Private types and data members
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -135,6 +164,37 @@ private:
     // How to combine category distances to obtain a function distance
     Statistic categoryAccumulatorType_;
 
+    static const size_t INVALID_INDEX = -1;             // no such node or function in the index
+
+    // Functions in the nearest-function index and their signatures.
+    struct IndexedFunction {
+        Partitioner2::Function::Ptr function;
+        std::vector<double> signature;                  // fixed-length summary of the function's characteristic values
+
+        IndexedFunction(const Partitioner2::Function::Ptr &function, const std::vector<double> &signature)
+            : function(function), signature(signature) {}
+    };
+
+    // Vantage-point tree node. Interior nodes partition the functions by their signature distance from the vantage function;
+    // leaves list functions directly.
+    struct IndexNode {
+        size_t vantage;                                 // index into indexedFunctions_, or INVALID_INDEX for a leaf
+        double radius;                                  // median distance from the vantage function
+        size_t inside, outside;                         // child nodes within and beyond the radius
+        size_t begin, end;                              // range of indexOrder_ for a leaf's functions
+
+        IndexNode(size_t begin, size_t end)
+            : vantage(INVALID_INDEX), radius(0.0), inside(INVALID_INDEX), outside(INVALID_INDEX), begin(begin), end(end) {}
+    };
+
+    // Signature distance and index into indexedFunctions_.
+    typedef std::pair<double, size_t> IndexCandidate;
+
+    IndexSettings indexSettings_;
+    std::vector<IndexedFunction> indexedFunctions_;
+    std::vector<size_t> indexOrder_;                    // indexedFunctions_ indices arranged for the tree leaves
+    std::vector<IndexNode> indexNodes_;                 // root is the first node
+
     Progress::Ptr progress_;
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -149,6 +209,7 @@ public:
         categoryNames_.clear();
         functions_.clear();
         categoryAccumulatorType_ = AVERAGE;
+        clearIndex();
     }
     
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -169,6 +230,13 @@ public:
     /** Property: Object to which progress reports are made. */
     Rose::Progress::Ptr progress() const { return progress_; }
 
+    /** Property: Settings for the nearest-function index.
+     *
+     * @{ */
+    const IndexSettings& indexSettings() const { return indexSettings_; }
+    IndexSettings& indexSettings() { return indexSettings_; }
+    /** @} */
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // Category declarations
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -388,6 +456,19 @@ public:
     DistanceMatrix compareManyToManyMatrix(std::vector<Partitioner2::Function::Ptr>,
                                            std::vector<Partitioner2::Function::Ptr>) const;
 
+    /** Compare many functions to many others, keeping only the nearest.
+     *
+     *  Compares every function of the first list with every function of the second list like @ref compareManyToMany, but
+     *  returns a sparse matrix whose row @em i holds only the @p k functions of the second list nearest to function @em i of
+     *  the first list, sorted by increasing distance.  The rows are computed @p blockSize at a time, so the memory needed is
+     *  proportional to the number of functions rather than the number of pairs of functions.
+     *
+     *  This analysis operates in parallel using multi-threading. It honors the global thread count usually specified with the
+     *  <code>--threads=N</code> switch. */
+    SparseDistanceMatrix compareManyToManySparse(const std::vector<Partitioner2::Function::Ptr>&,
+                                                 const std::vector<Partitioner2::Function::Ptr>&,
+                                                 size_t k, size_t blockSize = 256) const;
+
     /** Minimum cost 1:1 mapping.
      *
      *  Compute the minimum cost 1:1 mapping of functions in the first list to those in the second.  The algorithm first calls
@@ -400,6 +481,17 @@ public:
     std::vector<FunctionPair> findMinimumCostMapping(const std::vector<Partitioner2::Function::Ptr> &list1,
                                                      const std::vector<Partitioner2::Function::Ptr> &list2) const;
 
+    /** Minimum cost 1:1 mapping using only the nearest candidates.
+     *
+     *  This is like the other @ref findMinimumCostMapping, except each function of the first list can only be paired with one
+     *  of its @p nCandidates nearest functions from the second list (see @ref compareManyToManySparse), or with a null
+     *  function at a cost equal to its distance from the null function. Functions of the second list that are not paired are
+     *  likewise paired with a null function. The mapping is found with @ref findMinimumSparseAssignment, so time and memory
+     *  grow with the number of candidates rather than the square of the number of functions, and dlib is not required. */
+    std::vector<FunctionPair> findMinimumCostMapping(const std::vector<Partitioner2::Function::Ptr> &list1,
+                                                     const std::vector<Partitioner2::Function::Ptr> &list2,
+                                                     size_t nCandidates) const;
+
     /** Compute distances between sets of functions.
      *
      *  This is a low-level function to compute the distance between all pairs of functions from list1 and list2 in
@@ -409,6 +501,50 @@ public:
                                          const std::vector<Partitioner2::Function::Ptr> &list2,
                                          size_t nThreads) const;
 
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Nearest-function queries
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+    /** Build an index for finding similar functions.
+     *
+     *  Comparing one function with all others takes time proportional to the number of functions, which is too slow when
+     *  searching a large corpus.  The index summarizes each function's characteristic values as a fixed-length signature: the
+     *  centroid and size of each point cloud, and a histogram of the values and the average length of each category of ordered
+     *  lists, each scaled by the category weight.  The signatures are organized as a vantage-point tree so that the functions
+     *  whose signatures are nearest a query can be found without examining most of the others.
+     *
+     *  If no functions are specified then all functions having characteristic values are indexed. Any previous index is
+     *  replaced.  The index is not updated when characteristic values are inserted, so it should be built after the
+     *  characteristic values are populated.
+     *
+     * @{ */
+    void buildIndex();
+    void buildIndex(const std::vector<Partitioner2::Function::Ptr>&);
+    /** @} */
+
+    /** Remove all functions from the index. */
+    void clearIndex();
+
+    /** Number of functions in the index. */
+    size_t indexSize() const { return indexedFunctions_.size(); }
+
+    /** Find functions similar to the specified function.
+     *
+     *  Returns up to @p k indexed functions that are approximately the nearest to the @p needle, sorted by increasing
+     *  distance.  The index is used to choose <code>k * oversampling</code> candidates (see @ref IndexSettings) whose
+     *  signatures are nearest the needle's signature, and the candidates are then compared with the needle using @ref
+     *  compareOneToMany.  The distances are therefore the same as for @ref compare, but some of the @p k nearest functions may
+     *  be missed if their signatures are not among the nearest.  Use @ref measureRecall to choose a suitable oversampling. */
+    std::vector<FunctionDistancePair> findNearest(const Partitioner2::Function::Ptr &needle, size_t k) const;
+
+    /** Measure the accuracy of the index.
+     *
+     *  For each of the specified @p needle functions, compares the @p k nearest functions returned by @ref findNearest with
+     *  the @p k nearest found by comparing the needle with every indexed function, and returns the average fraction of the
+     *  true nearest functions that were found.  An approximate neighbor whose distance equals that of the k'th true neighbor
+     *  counts as found.  This is as slow as comparing each needle with all indexed functions. */
+    double measureRecall(const std::vector<Partitioner2::Function::Ptr> &needles, size_t k) const;
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // Sorting
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -457,6 +593,21 @@ public:
      *  This function will only work if ROSE has been compiled with dlib support. Otherwise it throws an @ref Exception. */
     static std::vector<size_t> findMinimumAssignment(const DistanceMatrix&);
 
+    /** Find minimum mapping from rows to columns of a sparse matrix.
+     *
+     *  Finds a mapping from rows to columns such that each row is assigned to at most one of the columns present in that row
+     *  of the @p matrix, each column is assigned to at most one row, and the total cost is minimized. The cost is the sum of
+     *  the matrix values for the assignments, plus @p rowCosts[i] for each row @em i that is not assigned and @p
+     *  columnCosts[j] for each column @em j that is not assigned. The number of rows in the matrix must equal the size of @p
+     *  rowCosts, and the number of columns is the size of @p columnCosts.  Returns a vector V such that V[i] = j maps row i
+     *  to column j, or V[i] = @ref NO_ASSIGNMENT.
+     *
+     *  Rows are added to the mapping one at a time along shortest augmenting paths (the Hungarian method with Dijkstra's
+     *  algorithm), which visit only the matrix values that are present. Unlike @ref findMinimumAssignment, this doesn't
+     *  depend on dlib. */
+    static std::vector<size_t> findMinimumSparseAssignment(const SparseDistanceMatrix&, const std::vector<double> &rowCosts,
+                                                           const std::vector<double> &columnCosts);
+
     /** Total cost of a mapping.
      *
      *  Given a square matrix and a 1:1 mapping from rows to columns, return the total cost of the mapping. The @p assignment
@@ -478,6 +629,16 @@ public:
 private:
     static double comparePointClouds(const PointCloud&, const PointCloud&);
     static double compareOrderedLists(const OrderedLists&, const OrderedLists&);
+
+    // Fixed-length summary of a function's characteristic values for the nearest-function index.
+    std::vector<double> signature(const Partitioner2::Function::Ptr&) const;
+
+    // Build the index subtree for indexOrder_[begin,end) and return its node number.
+    size_t buildIndexNode(size_t begin, size_t end);
+
+    // Update the nCandidates functions whose signatures are nearest to the specified signature.
+    void searchIndex(size_t nodeId, const std::vector<double> &signature, size_t nCandidates,
+                     std::vector<IndexCandidate> &nearest /*in,out*/) const;
 };
 
 std::ostream& operator<<(std::ostream&, const FunctionSimilarity&);
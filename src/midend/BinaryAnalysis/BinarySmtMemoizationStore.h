@@ -0,0 +1,121 @@
+#ifndef Rose_BinaryAnalysis_SmtMemoizationStore_H
+#define Rose_BinaryAnalysis_SmtMemoizationStore_H
+
+#include <BinarySmtSolver.h>
+#include <boost/filesystem.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+#include <Sawyer/Optional.h>
+#include <Sawyer/SharedObject.h>
+#include <Sawyer/SharedPointer.h>
+
+namespace Rose {
+namespace BinaryAnalysis {
+
+/** Persistent memoization of SMT solver results.
+ *
+ *  An @ref SmtSolver normally memoizes its results in a table that lives only as long as the solver object. This class
+ *  provides a memoization table that is stored in a file so that results can be reused by later runs of a tool and by other
+ *  processes that are running concurrently on the same machine.
+ *
+ *  The table is keyed by the hash of the solver's assertions after their variables have been renumbered in a canonical way
+ *  (see @ref SmtSolver::normalizeVariables), therefore two queries that differ only in the names of their variables share an
+ *  entry.  Each entry stores the satisfiability result and, for satisfiable queries, the evidence in terms of the normalized
+ *  variables when that evidence consists solely of variables bound to constants.
+ *
+ *  The file is append-only: new results are appended as self-describing, checksummed records while holding an exclusive
+ *  advisory lock on the file, and existing records are never modified. Readers map the file into memory and build an
+ *  in-memory index from hash to record; when a lookup misses and the file has grown (because this or another process appended
+ *  to it) the new records are mapped and indexed.  A record left incomplete by a process that died while appending fails its
+ *  checksum and is ignored, and it's removed by the next process that appends a record. Unknown results (e.g., solver
+ *  timeouts) are never stored. Records are written in the host's native byte order, and a file written on a host with a
+ *  different byte order is rejected.
+ *
+ *  Stores are shared: all calls to @ref instance for the same file in one process return the same object, which can be
+ *  attached to any number of solvers (see @ref SmtSolver::persistentMemoization).  All methods are thread safe. */
+class SmtMemoizationStore: public Sawyer::SharedObject, private boost::noncopyable {
+public:
+    /** Reference counting pointer for memoization stores. */
+    typedef Sawyer::SharedPointer<SmtMemoizationStore> Ptr;
+
+    /** One memoized result. */
+    struct Record {
+        SmtSolver::Satisfiable result;                  /**< Satisfiability of the normalized query. */
+        bool hasEvidence;                               /**< Whether the evidence was stored with the result. */
+        SmtSolver::ExprExprMap evidence;                /**< Evidence in terms of normalized variables. */
+
+        Record()
+            : result(SmtSolver::SAT_UNKNOWN), hasEvidence(false) {}
+    };
+
+    /** Store statistics. */
+    struct Stats {
+        size_t nHits;                                   /**< Number of lookups that found a record. */
+        size_t nMisses;                                 /**< Number of lookups that found no record. */
+        size_t nInserts;                                /**< Number of records appended by this process. */
+        size_t nRefreshes;                              /**< Number of times the file was remapped to index new records. */
+
+        Stats()
+            : nHits(0), nMisses(0), nInserts(0), nRefreshes(0) {}
+    };
+
+private:
+    typedef boost::unordered_map<SymbolicExpr::Hash, size_t /*file offset*/> Index;
+
+    mutable boost::mutex mutex_;                        // protects all following data members
+    boost::filesystem::path fileName_;
+    int fd_;                                            // open file descriptor
+    const uint8_t *map_;                                // read-only mapping of the file, or null
+    size_t mapSize_;                                    // number of bytes mapped
+    size_t indexedSize_;                                // records before this offset have been indexed
+    Index index_;
+    Stats stats_;
+
+protected:
+    // Use instance() instead.
+    explicit SmtMemoizationStore(const boost::filesystem::path&);
+
+public:
+    ~SmtMemoizationStore();
+
+    /** Open or create a store.
+     *
+     *  Returns the store for the specified file, creating the file if it doesn't exist. Within a single process all calls for
+     *  the same file return the same store object. Throws an @ref SmtSolver::Exception if the file cannot be opened or is not
+     *  a memoization file. */
+    static Ptr instance(const boost::filesystem::path &fileName);
+
+    /** Name of the file holding the memoized results. */
+    const boost::filesystem::path& fileName() const { return fileName_; }
+
+    /** Look up a result.
+     *
+     *  Returns the record for the specified normalized hash, or nothing if the result is not known. */
+    Sawyer::Optional<Record> find(SymbolicExpr::Hash);
+
+    /** Append a result.
+     *
+     *  Saves the result for the specified normalized hash. If @p evidence is non-null and consists only of variables bound to
+     *  constants then it is saved with the result. Results already present in the store and @ref SmtSolver::SAT_UNKNOWN
+     *  results are not saved. Returns true if a record was appended to the file. */
+    bool insert(SymbolicExpr::Hash, SmtSolver::Satisfiable, const SmtSolver::ExprExprMap *evidence = NULL);
+
+    /** Number of distinct results indexed so far. */
+    size_t nEntries() const;
+
+    /** Statistics for this store within this process. */
+    Stats statistics() const;
+
+private:
+    void createHeaderNS();
+    void refreshNS();
+    void indexNS();
+    void unmapNS();
+    Record decodeNS(size_t offset) const;
+};
+
+} // namespace
+} // namespace
+
+#endif
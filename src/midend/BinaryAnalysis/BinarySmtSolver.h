@@ -12,6 +12,7 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/unordered_map.hpp>
 #include <inttypes.h>
+#include <Sawyer/Optional.h>
 #include <Sawyer/SharedObject.h>
 #include <Sawyer/SharedPointer.h>
 
@@ -21,6 +22,9 @@ namespace BinaryAnalysis {
 /** Reference-counting pointer for SMT solvers. */
 typedef Sawyer::SharedPointer<class SmtSolver> SmtSolverPtr;
 
+/** Reference-counting pointer for persistent SMT memoization stores. */
+typedef Sawyer::SharedPointer<class SmtMemoizationStore> SmtMemoizationStorePtr;
+
 class CompareLeavesByName {
 public:
     bool operator()(const SymbolicExpr::LeafPtr&, const SymbolicExpr::LeafPtr&) const;
@@ -89,6 +93,9 @@ public:
         size_t input_size;                              /**< Bytes of input generated for satisfiable(). */
         size_t output_size;                             /**< Amount of output produced by the SMT solver. */
         size_t memoizationHits;                         /**< Number of times memoization supplied a result. */
+        size_t persistentMemoizationHits;               /**< Number of results supplied by the persistent memoization store. */
+        size_t persistentMemoizationMisses;             /**< Number of persistent memoization lookups that found nothing. */
+        size_t persistentMemoizationInserts;            /**< Number of results saved to the persistent memoization store. */
         size_t nSolversCreated;                         /**< Number of solvers created. Only for class statistics. */
         size_t nSolversDestroyed;                       /**< Number of solvers destroyed. Only for class statistics. */
         double prepareTime;                             /**< Time spent creating assertions before solving. */
@@ -97,7 +104,8 @@ public:
         // Remember to add all data members to resetStatistics()
 
         Stats()
-            : ncalls(0), input_size(0), output_size(0), memoizationHits(0), nSolversCreated(0), nSolversDestroyed(0),
+            : ncalls(0), input_size(0), output_size(0), memoizationHits(0), persistentMemoizationHits(0),
+              persistentMemoizationMisses(0), persistentMemoizationInserts(0), nSolversCreated(0), nSolversDestroyed(0),
               prepareTime(0.0), solveTime(0.0), evidenceTime(0.0) {
         }
     };
@@ -189,8 +197,11 @@ protected:
     TermNames termNames_;                               // maps ROSE exprs to SMT exprs and their basic type
     Memoization memoization_;                           // cached of previously computed results
     bool doMemoization_;                                // use the memoization_ table?
+    bool incremental_;                                  // keep executable solvers running between checks?
+    Sawyer::Optional<double> timeout_;                  // maximum seconds per incremental check
     SymbolicExpr::Hash latestMemoizationId_;            // key for last found or inserted memoization, or zero
     SymbolicExpr::ExprExprHashMap latestMemoizationRewrite_; // variables rewritten, need to be undone when parsing evidence
+    SmtMemoizationStorePtr persistentMemoization_;      // optional memoization shared across solvers and processes
 
     // Statistics
     static boost::mutex classStatsMutex;
@@ -216,8 +227,11 @@ private:
         // termNames_                -- not serialized
         // memoization_              -- not serialized
         // doMemoization_            -- not serialized
+        // incremental_              -- not serialized
+        // timeout_                  -- not serialized
         // latestMemoizationId_      -- not serialized
         // latestMemoizationRewrite_ -- not serialized
+        // persistentMemoization_    -- not serialized
         // classStatsMutex           -- not serialized
         // classStats                -- not serialized
         // stats                     -- not serialized
@@ -235,7 +249,8 @@ protected:
      *  situation by reading the @p linkage property, or just wait for one of the other methods to throw an @ref
      *  SmtSolver::Exception. */
     SmtSolver(const std::string &name, unsigned linkages)
-        : name_(name), errorIfReset_(false), linkage_(LM_NONE), doMemoization_(true), latestMemoizationId_(0) {
+        : name_(name), errorIfReset_(false), linkage_(LM_NONE), doMemoization_(true), incremental_(false),
+          latestMemoizationId_(0) {
         init(linkages);
     }
     
@@ -326,6 +341,44 @@ public:
         return memoization_.size();
     }
 
+    /** Property: Persistent memoization store.
+     *
+     *  If non-null and memoization is enabled, then results that are not found in this solver's own memoization table are
+     *  looked up in this store before invoking the solver, and newly computed results are appended to the store. The store
+     *  can be shared by any number of solvers and processes. A store is attached automatically to new solvers when the
+     *  "--smt-memoization" command-line switch is used.  See @ref SmtMemoizationStore.
+     *
+     * @{ */
+    const SmtMemoizationStorePtr& persistentMemoization() const { return persistentMemoization_; }
+    void persistentMemoization(const SmtMemoizationStorePtr &store) { persistentMemoization_ = store; }
+    /** @} */
+
+    /** Property: Incremental solving for executable linkage.
+     *
+     *  Solvers that use library linkage keep their state between calls to @ref check and only the assertions that were
+     *  inserted since the previous check are sent to the solver. Solvers that use executable linkage normally run the executable
+     *  once per check with all the assertions. If this property is set and the solver supports it, an executable solver is
+     *  instead started once and kept running, and the solver object sends it only the assertions, @ref push and @ref pop
+     *  operations that happened since the previous check. This is useful when consecutive checks share most of their
+     *  assertions, such as when exploring paths depth first. Solvers that don't support incremental mode ignore this property.
+     *
+     *  Changing this property takes effect at the next @ref check.
+     *
+     * @{ */
+    bool incremental() const { return incremental_; }
+    virtual void incremental(bool b) { incremental_ = b; }
+    /** @} */
+
+    /** Property: Time limit for each check.
+     *
+     *  If set, an executable solver running in @ref incremental mode that hasn't answered a check within this many seconds is
+     *  killed, and the check returns @ref SAT_UNKNOWN. The next check starts a new solver. Other solvers ignore this property.
+     *
+     * @{ */
+    const Sawyer::Optional<double>& timeout() const { return timeout_; }
+    void timeout(const Sawyer::Optional<double> &seconds) { timeout_ = seconds; }
+    /** @} */
+
     
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // High-level abstraction for testing satisfiability.
@@ -383,8 +436,8 @@ public:
      *  Pushes a new, empty set of assertions onto the solver stack.
      *
      *  Note that although text-based solvers (executables) accept push and pop methods, they have no effect on the speed of
-     *  the solver because ROSE invokes the executable in batch mode. In this case the push and pop apply to the stack within
-     *  this solver object in ROSE.
+     *  the solver unless the @ref incremental property is set, because otherwise ROSE invokes the executable in batch mode. In
+     *  this case the push and pop apply to the stack within this solver object in ROSE.
      *
      *  See also, @ref pop. */
     virtual void push();
@@ -579,6 +632,17 @@ protected:
      *  expression.  This information is parsed by this function and added to a mapping of variable to value. */
     virtual void parseEvidence() {};
 
+    /** Memoized evidence for persistent memoization.
+     *
+     *  Subclasses that memoize evidence of satisfiability override these in order to exchange evidence with the persistent
+     *  memoization store. The evidence is in terms of normalized variables (see @ref normalizeVariables). The first method
+     *  returns false if no evidence is memoized for the specified hash.
+     *
+     * @{ */
+    virtual bool findMemoizedEvidence(SymbolicExpr::Hash, ExprExprMap &evidence /*out*/) const { return false; }
+    virtual void insertMemoizedEvidence(SymbolicExpr::Hash, const ExprExprMap&) {}
+    /** @} */
+
     /** Normalize expressions by renaming variables.
      *
      *  This is used during memoization to rename all the variables. It performs a depth-first search and renames each variable
@@ -4,6 +4,7 @@
 #include <BinarySmtSolver.h>
 #include <boost/filesystem.hpp>
 #include <boost/unordered_map.hpp>
+#include <Sawyer/Stopwatch.h>
 
 namespace Rose {
 namespace BinaryAnalysis {
@@ -15,16 +16,31 @@ private:
     std::string shellArgs_;                             // extra arguments for command (passed through shell)
     ExprExprMap varsForSets_;                           // variables to use for sets
 
+    // Incremental mode, used when the "incremental" property is set and getIncrementalCommand is not empty.
+    int childPid_;                                      // running solver process, or -1
+    int toChild_;                                       // solver's standard input, or -1
+    int fromChild_;                                     // solver's standard output, or -1
+    std::string sendBuffer_;                            // input not yet written to the solver
+    std::string receiveBuffer_;                         // output read from the solver but not yet returned
+    std::vector<size_t> sentStack_;                     // number of assertions sent per level; lazily parallel with stack_
+    VariableSet declaredVars_;                          // variables declared in the running solver
+    TermNames definedTerms_;                            // common subexpressions defined in the running solver
+
 protected:
     ExprExprMap evidence;
     typedef boost::unordered_map<SymbolicExpr::Hash, ExprExprMap> MemoizedEvidence;
     MemoizedEvidence memoizedEvidence;
+    size_t nCses_;                                      // number of common subexpression names emitted so far
 
 protected:
     // Reference counted. Use instance() or create() instead.
     explicit SmtlibSolver(const std::string &name, const boost::filesystem::path &executable, const std::string &shellArgs = "",
                           unsigned linkages = LM_EXECUTABLE)
-        : SmtSolver(name, linkages), executable_(executable), shellArgs_(shellArgs) {}
+        : SmtSolver(name, linkages), executable_(executable), shellArgs_(shellArgs), childPid_(-1), toChild_(-1),
+          fromChild_(-1), nCses_(0) {}
+
+public:
+    ~SmtlibSolver();
 
 public:
     /** Construct a solver using the specified program.
@@ -52,8 +68,17 @@ public:
     
 public:
     virtual void reset() ROSE_OVERRIDE;
+    virtual void pop() ROSE_OVERRIDE;
     virtual void generateFile(std::ostream&, const std::vector<SymbolicExpr::Ptr> &exprs, Definitions*) ROSE_OVERRIDE;
     virtual std::string getCommand(const std::string &configName) ROSE_OVERRIDE;
+
+    /** Command for incremental mode.
+     *
+     *  Returns the shell command that runs the solver so that it reads SMT-LIB commands interactively from its standard input,
+     *  or an empty string if this solver cannot be used incrementally, in which case the @ref incremental property is ignored.
+     *  The solver must accept the ":global-declarations" option and must not need the functions emitted by @ref
+     *  outputBvxorFunctions or @ref outputComparisonFunctions.  The default implementation returns an empty string. */
+    virtual std::string getIncrementalCommand();
     virtual std::string getErrorMessage(int exitStatus) ROSE_OVERRIDE;
     virtual void findVariables(const SymbolicExpr::Ptr&, VariableSet&) ROSE_OVERRIDE;
     virtual SymbolicExpr::Ptr evidenceForName(const std::string&) ROSE_OVERRIDE;
@@ -62,6 +87,25 @@ public:
     virtual void clearMemoization() ROSE_OVERRIDE;
 
 protected:
+    /** Name of solver executable. */
+    const boost::filesystem::path& executable() const { return executable_; }
+
+    /** Extra arguments for the solver executable. */
+    const std::string& shellArgs() const { return shellArgs_; }
+
+    virtual Satisfiable checkExe() ROSE_OVERRIDE;
+
+    /** Check satisfiability using a running solver.
+     *
+     *  Starts the solver if necessary, sends it the push, pop, and assertion commands that bring it up to date with this
+     *  object's assertion stack, and asks whether the assertions are satisfiable. */
+    virtual Satisfiable checkIncremental();
+
+    /** Stop the running solver, if any.
+     *
+     *  The next incremental check will start a new solver and send it all assertions. */
+    void stopIncremental();
+
     /** Specify variable to use for OP_SET.
      *
      *  Each OP_SET needs a free variable to choose from the available members of the set.  This function sets (two arguments)
@@ -73,6 +117,8 @@ protected:
     /** @} */
 
     virtual void parseEvidence() ROSE_OVERRIDE;
+    virtual bool findMemoizedEvidence(SymbolicExpr::Hash, ExprExprMap &evidence /*out*/) const ROSE_OVERRIDE;
+    virtual void insertMemoizedEvidence(SymbolicExpr::Hash, const ExprExprMap&) ROSE_OVERRIDE;
 
     /** Generate definitions for bit-wise XOR functions.
      *
@@ -167,6 +213,13 @@ protected:
     virtual void outputComments(std::ostream&, const std::vector<SymbolicExpr::Ptr>&);
     virtual void outputCommonSubexpressions(std::ostream&, const std::vector<SymbolicExpr::Ptr>&);
     virtual void outputAssertion(std::ostream&, const SymbolicExpr::Ptr&);
+
+private:
+    void startIncremental();
+    void sendIncremental(const std::string&);
+    void flushIncremental();
+    Sawyer::Optional<std::string> readIncrementalResponse(const Sawyer::Stopwatch &checkTime);
+    void outputIncrementalAssertion(std::ostream&, const SymbolicExpr::Ptr&);
 };
 
 } // namespace
@@ -841,7 +841,29 @@ public:
          *  length, then removes any string whose memory addresses overlap with any prior string in the list. */
         bool keepingOnlyLongest;
 
-        Settings(): minLength(5), maxLength(-1), maxOverlap(8), keepingOnlyLongest(true) {}
+        /** Number of threads to use when searching.
+         *
+         *  Large contiguous parts of memory are split into chunks that are searched concurrently.  The results are identical,
+         *  and in the same order, regardless of the number of threads. A value of zero means use the hardware concurrency. */
+        size_t nThreads;
+
+        /** Size of each chunk when searching with more than one thread.
+         *
+         *  Each thread searches a chunk of about this many bytes at a time, continuing a little past the end of the chunk if
+         *  a string could still be in progress there. Contiguous memory that isn't larger than this is searched by a single
+         *  thread. */
+        size_t chunkSize;
+
+        /** Whether to skip octets at which no string can start.
+         *
+         *  When set, unanchored searches first determine which octets (or pairs of octets for large searches) cause every
+         *  encoder to give up without producing a string, and don't start decoding at such octets. The results are the same
+         *  either way; clearing this is only useful for measuring the benefit. */
+        bool filteringStarts;
+
+        Settings()
+            : minLength(5), maxLength(-1), maxOverlap(8), keepingOnlyLongest(true), nThreads(1), chunkSize(1024*1024),
+              filteringStarts(true) {}
     };
     
 private:
@@ -938,6 +960,10 @@ public:
      *  each byte from memory only one time, simultaneously attempting all encoders.  If the MemoryMap constraint contains an
      *  anchor point (e.g., @ref MemoryMap::at) then only strings starting at the specified address are returned.
      *
+     *  Unanchored searches use @ref Settings::nThreads "nThreads" threads, each searching its own chunks of memory. The
+     *  chunks are stitched together by the calling thread, scanning serially near a chunk boundary until its state agrees
+     *  with the state of the chunk's own search, so the results are the same as a single-threaded search.
+     *
      *  Example 1: Find all C-style, NUL-terminated, ASCII strings contaiing only printable characters (no control characters)
      *  and containing at least five characters but not more than 31 (not counting the NUL terminator).  Make sure that the
      *  string is in memory that is readable but not writable, and don't allow strings to overlap one another (i.e., "foobar"
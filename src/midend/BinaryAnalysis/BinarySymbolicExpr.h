@@ -225,6 +225,7 @@ protected:
     std::string comment_;             /**< Optional comment. Only for debugging; not significant for any calculation. */
     Hash hashval_;                    /**< Optional hash used as a quick way to indicate that two expressions are different. */
     boost::any userData_;             /**< Additional user-specified data. This is not part of the hash. */
+    unsigned internGeneration_;       /**< Nonzero if this node is the canonical node in the interning table. Not hashed. */
 
 #ifdef ROSE_HAVE_BOOST_SERIALIZATION_LIB
 private:
@@ -262,9 +263,9 @@ public:
 
 protected:
     Node()
-        : nBits_(0), domainWidth_(0), flags_(0), hashval_(0) {}
+        : nBits_(0), domainWidth_(0), flags_(0), hashval_(0), internGeneration_(0) {}
     explicit Node(const std::string &comment, unsigned flags=0)
-        : nBits_(0), domainWidth_(0), flags_(flags), comment_(comment), hashval_(0) {}
+        : nBits_(0), domainWidth_(0), flags_(flags), comment_(comment), hashval_(0), internGeneration_(0) {}
 
 public:
     /** User-supplied predicate to augment alias checking.
@@ -444,6 +445,12 @@ public:
     // used internally to set the hash value
     void hash(Hash);
 
+    /** Returns true if this node is the canonical node for its structure.
+     *
+     *  A node is canonical if it was returned by the interning table while interning is enabled. Two canonical nodes are
+     *  structurally equivalent if and only if they are the same node. See @ref interning. */
+    bool isInterned();
+
     /** A node with formatter. See the with_format() method. */
     class WithFormatter {
     private:
@@ -501,6 +508,12 @@ public:
 
 protected:
     void printFlags(std::ostream &o, unsigned flags, char &bracket);
+
+    // True if both nodes are canonical, in which case structural equivalence is the same as pointer equality.
+    bool bothInterned(const Ptr &other);
+
+private:
+    friend Ptr intern(const Ptr&);
 };
 
 /** Operator-specific simplification methods. */
@@ -729,22 +742,22 @@ public:
     static Ptr create(size_t nbits, Operator op, const Ptr &a,
                       const SmtSolverPtr &solver = SmtSolverPtr(), const std::string &comment="", unsigned flags=0) {
         InteriorPtr retval(new Interior(nbits, op, a, comment, flags));
-        return retval->simplifyTop(solver);
+        return retval->simplifyAndIntern(solver);
     }
     static Ptr create(size_t nbits, Operator op, const Ptr &a, const Ptr &b,
                       const SmtSolverPtr &solver = SmtSolverPtr(), const std::string &comment="", unsigned flags=0) {
         InteriorPtr retval(new Interior(nbits, op, a, b, comment, flags));
-        return retval->simplifyTop(solver);
+        return retval->simplifyAndIntern(solver);
     }
     static Ptr create(size_t nbits, Operator op, const Ptr &a, const Ptr &b, const Ptr &c,
                       const SmtSolverPtr &solver = SmtSolverPtr(), const std::string &comment="", unsigned flags=0) {
         InteriorPtr retval(new Interior(nbits, op, a, b, c, comment, flags));
-        return retval->simplifyTop(solver);
+        return retval->simplifyAndIntern(solver);
     }
     static Ptr create(size_t nbits, Operator op, const Nodes &children,
                       const SmtSolverPtr &solver = SmtSolverPtr(), const std::string &comment="", unsigned flags=0) {
         InteriorPtr retval(new Interior(nbits, op, children, comment, flags));
-        return retval->simplifyTop(solver);
+        return retval->simplifyAndIntern(solver);
     }
     /** @} */
 
@@ -780,6 +793,15 @@ public:
      *  Returns a new node if necessary, otherwise returns this. The SMT solver is optional and my be the null pointer. */
     Ptr simplifyTop(const SmtSolverPtr &solver = SmtSolverPtr());
 
+    /** Simplifies and interns the specified interior node.
+     *
+     *  This is the final step of the @ref create methods. When interning is disabled it is the same as @ref simplifyTop.
+     *  Otherwise the simplified result is replaced by its canonical node, and when no SMT solver is specified the result is
+     *  also memoized so that creating a structurally equivalent node later doesn't need to run the simplifiers again. Results
+     *  that contain variables created by the simplifiers are not memoized since each creation needs its own fresh variables.
+     *  See @ref interning. */
+    Ptr simplifyAndIntern(const SmtSolverPtr &solver = SmtSolverPtr());
+
     /** Perform constant folding.  This method returns either a new expression (if changes were mde) or the original
      *  expression. The simplifier is specific to the kind of operation at the node being simplified. */
     Ptr foldConstants(const Simplifier&);
@@ -1074,6 +1096,74 @@ Ptr makeZerop(const Ptr &a,
 /** @} */
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//                                      Hash consing
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/** Statistics for the interning table.
+ *
+ *  These are summed across all threads since the last call to @ref resetInterningStatistics. See @ref interning. */
+struct InterningStats {
+    size_t nLookups;                                    /**< Number of nodes presented to the interning table. */
+    size_t nHits;                                       /**< Number of lookups that found an existing equivalent node. */
+    size_t nInserts;                                    /**< Number of nodes that became canonical nodes. */
+    size_t nPurged;                                     /**< Number of canonical nodes removed because nothing else used them. */
+    size_t nLive;                                       /**< Number of canonical nodes currently in the table. */
+    size_t nSimplificationHits;                         /**< Number of times a memoized simplification was reused. */
+    size_t nSimplificationMisses;                       /**< Number of times simplification had to be computed. */
+    size_t nBytesSaved;                                 /**< Approximate bytes of nodes replaced by canonical nodes. */
+
+    InterningStats()
+        : nLookups(0), nHits(0), nInserts(0), nPurged(0), nLive(0), nSimplificationHits(0), nSimplificationMisses(0),
+          nBytesSaved(0) {}
+};
+
+/** Property: Whether expression nodes are interned.
+ *
+ *  When interning (also known as hash consing) is enabled, the node factories in @ref Interior and @ref Leaf return the
+ *  canonical node for each expression structure instead of allocating a new node every time. Structurally equivalent
+ *  expressions therefore share one node, which reduces memory for analyses such as symbolic instruction semantics that build
+ *  the same subexpressions over and over, and makes @ref Node::isEquivalentTo a pointer comparison for canonical nodes.
+ *  Simplification results for interior nodes created without an SMT solver are also memoized.
+ *
+ *  Interning is disabled by default. The table is sharded and each shard is protected by its own mutex, so interning is thread
+ *  safe. Canonical nodes that are referenced only by the table are purged periodically as the table grows.
+ *
+ *  Since canonical nodes are shared, anything that's not significant for equivalence is shared too: a node created with a
+ *  comment that is equivalent to an existing canonical node gets the canonical node's comment, and attributes and user data
+ *  attached to a canonical node are visible through all equivalent expressions. Interior nodes whose children are not
+ *  canonical (e.g., because they were created before interning was enabled) are not interned.
+ *
+ *  Disabling interning clears the table; nodes that were canonical remain valid but are no longer considered canonical.
+ *
+ * @{ */
+bool interning();
+void interning(bool);
+/** @} */
+
+/** Returns the canonical node for an expression.
+ *
+ *  If interning is enabled, returns the canonical node that's structurally equivalent to the argument, adding the argument to
+ *  the table if there is no such node. If interning is disabled, or the node is not eligible for interning, then the argument
+ *  is returned. The children of an interior node are not interned by this function; they are normally canonical already
+ *  because they were created by the node factories. */
+Ptr intern(const Ptr&);
+
+/** Remove unused canonical nodes.
+ *
+ *  Removes from the interning table all nodes that are referenced only by the table, and clears the simplification memo.
+ *  This happens automatically as the table grows, but can also be called explicitly. Returns the number of nodes removed. */
+size_t purgeInterned();
+
+/** Interning statistics.
+ *
+ *  Returns the interning statistics summed across all shards of the table.  The @c nLive member is the current table size and
+ *  is not affected by @ref resetInterningStatistics. */
+InterningStats interningStatistics();
+
+/** Reset interning statistics to zero. */
+void resetInterningStatistics();
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //                                      Miscellaneous functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1,10 +1,14 @@
 #ifndef ROSE_BinaryAnalysis_BinaryToSource_H
 #define ROSE_BinaryAnalysis_BinaryToSource_H
 
+#include <boost/filesystem.hpp>
 #include <Diagnostics.h>
 #include <Partitioner2/Partitioner.h>
 #include <RoseException.h>
 #include <Sawyer/CommandLine.h>
+#include <Sawyer/Map.h>
+#include <Sawyer/Set.h>
+#include <Sawyer/Synchronization.h>
 #include <SourceAstSemantics2.h>
 #include <TraceSemantics2.h>
 
@@ -43,6 +47,20 @@ public:
         /** Whether to zero the memory array, or just allocated with malloc. */
         bool zeroMemoryArray;
 
+        /** Parallelism for generating the functions.
+         *
+         *  Each function's code is generated by one thread into its own buffer and the buffers are emitted in the same order
+         *  as the partitioner's function list regardless of the parallelism. Zero means use the hardware parallelism; no value
+         *  means use the global setting, @ref Rose::CommandLine::GenericSwitchArgs::threads. */
+        Sawyer::Optional<size_t> nThreads;
+
+        /** Name of file holding the translation cache.
+         *
+         *  If non-empty, the translation cache is initialized from this file when source code is generated (if the file
+         *  exists) and is written back to the file afterward, so that basic blocks that haven't changed since the previous run
+         *  need not be translated again. See @ref loadTranslationCache. */
+        std::string translationCache;
+
         /** Constructs the default settings. */
         Settings()
             : traceRiscOps(false), traceInsnExecution(false), allocateMemoryArray(false), zeroMemoryArray(false) {}
@@ -56,27 +74,49 @@ public:
     };
 
 private:
+    // The instruction semantics machinery used to generate code. Each thread needs its own.
+    struct Raiser {
+        InstructionSemantics2::SourceAstSemantics::RiscOperatorsPtr ops;
+        InstructionSemantics2::TraceSemantics::RiscOperatorsPtr tracingOps;
+        InstructionSemantics2::BaseSemantics::DispatcherPtr cpu;
+    };
+
+    // Parts of a function's code that depend on the partitioner, which is not thread safe.
+    struct BasicBlockPlan {
+        Partitioner2::BasicBlock::Ptr bblock;
+        std::string epilogue;                           // function call, "break", etc. following the instructions
+    };
+    typedef std::vector<BasicBlockPlan> FunctionPlan;
+
+    // Generates code for functions in parallel.
+    class FunctionWorker;
+
+    // Translated instructions of basic blocks indexed by the block's address, instruction bytes, etc.
+    typedef Sawyer::Container::Map<std::string /*key*/, std::string /*C code*/> TranslationCache;
+
     static Diagnostics::Facility mlog;
     Settings settings_;
     Disassembler *disassembler_;
-    InstructionSemantics2::SourceAstSemantics::RiscOperatorsPtr raisingOps_;
-    InstructionSemantics2::TraceSemantics::RiscOperatorsPtr tracingOps_;
-    InstructionSemantics2::BaseSemantics::DispatcherPtr raisingCpu_;
-    
+    Raiser raiser_;
+    mutable SAWYER_THREAD_TRAITS::Mutex mutex_;         // protects the following data members
+    TranslationCache translationCache_;
+    Sawyer::Container::Set<std::string> usedTranslations_; // keys found or inserted since generateSource was called
+    size_t nCacheHits_, nCacheMisses_;
+
 public:
     /** Default constructor.
      *
      *  Constructs an analysis object that is not tied to any particular architecture yet, and which uses default
      *  settings. */
     BinaryToSource()
-        : disassembler_(NULL) {}
+        : disassembler_(NULL), nCacheHits_(0), nCacheMisses_(0) {}
 
     /** Construct the analyzer with specified settings.
      *
      *  Constructs an analysis object that is not tied to any particular architecture yet, but which uses the specified
      *  settings. */
     explicit BinaryToSource(const Settings &settings)
-        : settings_(settings), disassembler_(NULL) {}
+        : settings_(settings), disassembler_(NULL), nCacheHits_(0), nCacheMisses_(0) {}
 
     /** Command-line switch parsing. */
     static Sawyer::CommandLine::SwitchGroup commandLineSwitches(Settings&);
@@ -99,6 +139,42 @@ public:
      *  necessary. */
     void generateSource(const Partitioner2::Partitioner&, std::ostream&);
 
+    /** Translation cache.
+     *
+     *  The C code generated for the instructions of each basic block is cached, keyed by the version of ROSE, the
+     *  architecture, the block's address, the bytes of its instructions, and the settings that affect the translation, so
+     *  entries made by other versions of ROSE, whose instruction semantics may differ, are never found. Blocks whose keys
+     *  are found in the cache are not translated again, which is useful when generating source code for a new build of a
+     *  specimen in which most blocks haven't changed. Since the generated code refers to absolute addresses, a block that
+     *  moved is not found in the cache. Blocks found in the cache are not traced by the @ref Settings::traceRiscOps
+     *  "traceRiscOps" setting.
+     *
+     *  The @ref loadTranslationCache method adds the entries from a file created by @ref saveTranslationCache to this
+     *  object's cache and throws an @ref Exception if the file cannot be read or is not a translation cache. The @ref
+     *  saveTranslationCache method writes all entries to a file, throwing an @ref Exception if the file cannot be created.
+     *  The @ref pruneTranslationCache method removes the entries that were neither found nor inserted by the most recent
+     *  @ref generateSource, which does this itself before saving the @ref Settings::translationCache "translationCache" file
+     *  so that the file doesn't keep growing as a specimen changes.
+     *
+     * @{ */
+    void loadTranslationCache(const boost::filesystem::path&);
+    void saveTranslationCache(const boost::filesystem::path&) const;
+    void pruneTranslationCache();
+    void clearTranslationCache();
+    size_t translationCacheSize() const;
+    /** @} */
+
+    /** Translation cache statistics.
+     *
+     *  Number of basic blocks whose translations were found or not found in the translation cache since this analysis
+     *  object was constructed or the statistics were reset.
+     *
+     * @{ */
+    size_t nCacheHits() const;
+    size_t nCacheMisses() const;
+    void resetCacheStatistics();
+    /** @} */
+
 #if 0 // [Robb P. Matzke 2015-10-06]: not implemented yet
     /** Build a C source AST from a binary AST.
      *
@@ -112,6 +188,9 @@ private:
     // (Re)initialize the instruction semantics machinery so it is suitable for this architecture.
     void init(const Partitioner2::Partitioner&);
 
+    // Create new instruction semantics machinery for the architecture chosen by init.
+    Raiser createRaiser() const;
+
     // Emit the file prologue, #include statements, extern declarations, etc.
     void emitFilePrologue(const Partitioner2::Partitioner&, std::ostream&);
 
@@ -122,16 +201,25 @@ private:
     void defineInterrupts(std::ostream&);
 
     // Emit accumulated side effects and/or SSA. */
-    void emitEffects(std::ostream&);
+    void emitEffects(const Raiser&, std::ostream&);
 
     // Emit code for one instruction
-    void emitInstruction(SgAsmInstruction*, std::ostream&);
+    void emitInstruction(const Raiser&, SgAsmInstruction*, std::ostream&);
+
+    // Code for the instructions of one basic block, from the translation cache if possible. Thread safe.
+    std::string translateBasicBlock(const Raiser&, const Partitioner2::BasicBlock::Ptr&);
+
+    // Translation cache key for a basic block.
+    std::string translationCacheKey(const Partitioner2::BasicBlock::Ptr&) const;
+
+    // Emit code for one basic block. Thread safe.
+    void emitBasicBlock(const Raiser&, const BasicBlockPlan&, std::ostream&);
 
-    // Emit code for one basic block
-    void emitBasicBlock(const Partitioner2::Partitioner&, const Partitioner2::BasicBlock::Ptr&, std::ostream&);
+    // Compute the parts of a function's code that depend on the partitioner.
+    FunctionPlan planFunction(const Partitioner2::Partitioner&, const Partitioner2::Function::Ptr&);
 
-    // Emit code for one function
-    void emitFunction(const Partitioner2::Partitioner&, const Partitioner2::Function::Ptr&, std::ostream&);
+    // Emit code for one function. Thread safe.
+    void emitFunction(const Raiser&, const Partitioner2::Function::Ptr&, const FunctionPlan&, std::ostream&);
 
     // Emit code for all functions
     void emitAllFunctions(const Partitioner2::Partitioner&, std::ostream&);
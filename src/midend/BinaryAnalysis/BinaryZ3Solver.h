@@ -155,6 +155,7 @@ public:
     virtual void parseEvidence() ROSE_OVERRIDE;
     virtual void pop() ROSE_OVERRIDE;
     virtual void selfTest() ROSE_OVERRIDE;
+    virtual std::string getIncrementalCommand() ROSE_OVERRIDE;
 protected:
     virtual void outputBvxorFunctions(std::ostream&, const std::vector<SymbolicExpr::Ptr>&) ROSE_OVERRIDE;
     virtual void outputComparisonFunctions(std::ostream&, const std::vector<SymbolicExpr::Ptr>&) ROSE_OVERRIDE;
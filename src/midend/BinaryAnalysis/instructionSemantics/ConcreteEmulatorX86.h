@@ -0,0 +1,121 @@
+#ifndef Rose_ConcreteEmulatorX86_H
+#define Rose_ConcreteEmulatorX86_H
+
+#include "ConcreteSemantics2.h"
+#include "DispatcherX86.h"
+#include <Sawyer/HashMap.h>
+
+namespace Rose {
+namespace BinaryAnalysis {
+
+class Disassembler;
+
+namespace InstructionSemantics2 {       // documented elsewhere
+namespace ConcreteSemantics {           // documented elsewhere
+
+/** Shared-ownership pointer to a basic block translating x86 emulator. See @ref heap_object_shared_ownership. */
+typedef boost::shared_ptr<class EmulatorX86> EmulatorX86Ptr;
+
+/** Fast concrete emulation of x86 code.
+ *
+ *  Emulating with @ref DispatcherX86::processInstruction dispatches every micro-operation through the virtual RISC operators
+ *  and allocates a new semantic value for each intermediate result.  This emulator instead translates each basic block once,
+ *  the first time it's executed, into a cached sequence of operations whose operands (register numbers, widths, immediate
+ *  values, and addressing modes) were decided at translation time.  The operations work directly on 64-bit integers and on
+ *  the memory map of the dispatcher's @ref ConcreteSemantics::MemoryState, so later executions of the block make no virtual
+ *  calls and allocate no semantic values.
+ *
+ *  Only the common integer instructions are translated.  Other instructions are handed to the dispatcher, with the registers
+ *  written back to its state before the instruction and read again afterward.  Either way the results are the same as
+ *  running the dispatcher alone, including the flags that the dispatcher leaves unspecified, which this domain represents as
+ *  zeros.  Segment registers are ignored when computing addresses, as they are by the concrete RISC operators, and the
+ *  operators' lazily updated initial state, if any, is not consulted.
+ *
+ *  The emulator has its own copy of the registers only while @ref run is executing; at all other times the dispatcher's state
+ *  holds the machine state and can be read or modified by the caller.  Translated blocks are not invalidated when memory
+ *  changes, so call @ref clearCache after modifying memory that contains instructions that were already executed.
+ *
+ *  Example:
+ *
+ * @code
+ *  BaseSemantics::RiscOperatorsPtr ops = ConcreteSemantics::RiscOperators::instance(regdict);
+ *  BaseSemantics::DispatcherPtr cpu = disassembler->dispatcher()->create(ops);
+ *  ConcreteSemantics::MemoryState::promote(ops->currentState()->memoryState())->memoryMap(map);
+ *  ops->writeRegister(cpu->instructionPointerRegister(), ops->number_(32, startVa));
+ *  ConcreteSemantics::EmulatorX86Ptr emulator = ConcreteSemantics::EmulatorX86::instance(cpu, disassembler);
+ *  emulator->run(1000000);
+ * @endcode */
+class EmulatorX86 {
+    struct Location;
+    struct Op;
+    struct Block;
+    struct Impl;                                        // translation and the operations themselves
+    typedef boost::shared_ptr<Block> BlockPtr;
+    typedef Sawyer::Container::HashMap<rose_addr_t, BlockPtr> Blocks;
+
+    DispatcherX86Ptr cpu_;
+    MemoryStatePtr memory_;
+    Disassembler *disassembler_;
+    MemoryMap::Ptr map_;                                // memory_'s map, refreshed whenever the dispatcher has run
+    size_t wordWidth_;                                  // width of the general purpose registers and instruction pointer
+    size_t nGprs_;                                      // number of general purpose registers
+    uint64_t wordMask_;                                 // mask for wordWidth_ bits
+    uint64_t regs_[17];                                 // general purpose registers by minor number; instruction pointer last
+    bool cf_, pf_, af_, zf_, sf_, of_;                  // status flags
+    Blocks blocks_;                                     // translated blocks by starting address
+    size_t nInstructions_;                              // total instructions executed
+    size_t nInterpreted_;                               // number of those executed by the dispatcher
+
+protected:
+    EmulatorX86(const DispatcherX86Ptr&, Disassembler*);
+
+public:
+    ~EmulatorX86();
+
+    /** Allocating constructor.
+     *
+     *  The dispatcher must be an x86 dispatcher for 32- or 64-bit code whose RISC operators are @ref
+     *  ConcreteSemantics::RiscOperators, and the disassembler is used to decode instructions from the dispatcher's memory
+     *  state. The disassembler must not be deleted while this emulator exists. */
+    static EmulatorX86Ptr instance(const BaseSemantics::DispatcherPtr&, Disassembler*);
+
+    /** Property: Dispatcher whose state is emulated. */
+    DispatcherX86Ptr dispatcher() const { return cpu_; }
+
+    /** Execute instructions.
+     *
+     *  Executes instructions starting at the address in the dispatcher's instruction pointer register until @p nInsns
+     *  instructions have been executed, and then returns @p nInsns.  The only way it stops early is by throwing one of the
+     *  exceptions of @ref DispatcherX86::processInstruction, or a @ref Disassembler::Exception if an instruction cannot be
+     *  decoded.  The dispatcher's state is up to date when this returns or throws. An instruction that throws counts as
+     *  executed, as it would if the dispatcher had processed it, so callers that catch the exception can use @ref
+     *  nInstructions to learn how many were executed. */
+    size_t run(size_t nInsns);
+
+    /** Discard all translated blocks. */
+    void clearCache();
+
+    /** Total number of instructions executed. */
+    size_t nInstructions() const { return nInstructions_; }
+
+    /** Number of executed instructions that were handed to the dispatcher because they were not translated. */
+    size_t nInterpreted() const { return nInterpreted_; }
+
+    /** Number of translated blocks in the cache. */
+    size_t nBlocks() const { return blocks_.size(); }
+
+private:
+    // Copy registers from the dispatcher's state into this object, and back again.
+    void loadState();
+    void saveState();
+
+    // Cached translation of the block starting at the specified address.
+    Block* blockAt(rose_addr_t va);
+};
+
+} // namespace
+} // namespace
+} // namespace
+} // namespace
+
+#endif
@@ -0,0 +1,372 @@
+#ifndef ROSE_BinaryAnalysis_InstructionSemantics2_MemoryCellHash_H
+#define ROSE_BinaryAnalysis_InstructionSemantics2_MemoryCellHash_H
+
+#include <BaseSemantics2.h>
+#include <boost/foreach.hpp>
+#include <MemoryCellState.h>
+#include <Sawyer/Map.h>
+
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/export.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/vector.hpp>
+
+namespace Rose {
+namespace BinaryAnalysis {
+namespace InstructionSemantics2 {
+namespace BaseSemantics {
+
+/** Shared-ownership pointer to a hash-based memory state. See @ref heap_object_shared_ownership. */
+typedef boost::shared_ptr<class MemoryCellHash> MemoryCellHashPtr;
+
+/** Page-indexed memory state.
+ *
+ *  This memory state has the same read, write, and merge semantics as @ref MemoryCellList with occlusions erased, but it does
+ *  not need to scan every cell in order to find the cells that might alias an address.  Each cell address is decomposed into
+ *  a base and an offset by @ref decomposeAddress. Concrete addresses have a base of zero and the address as the offset, and
+ *  a semantic domain can also decompose addresses like "esp_0 + 8" whose bases are symbolic. Cells that hold one byte and
+ *  whose addresses can be decomposed are stored in an open-addressing hash table whose buckets are pages of consecutive
+ *  offsets having the same base.  All other cells are stored in a short side list.
+ *
+ *  A domain that decomposes addresses promises that two addresses with the same base may alias one another if and only if
+ *  they also have the same offset, in which case they must alias one another. Under that rule a byte read only needs to
+ *  look at the one cell having the same base and offset and at those cells having other bases (or no base) that were
+ *  written more recently.  Each cell carries a serial number so that the cells returned by @ref scan are in the same
+ *  reverse chronological order as those returned by @ref MemoryCellList::scan.
+ *
+ *  The default configuration restricts memory cell values to be one byte wide, as does @ref MemoryCellList.
+ *
+ *  There is no ConcreteSemantics version of this state. The concrete @ref ConcreteSemantics::MemoryState has no cells: it
+ *  stores bytes directly in a memory map whose pages are allocated on demand, so reads and writes already take time that
+ *  doesn't depend on the number of addresses written. */
+class MemoryCellHash: public MemoryCellState {
+public:
+    /** Key for the base of a decomposed address. Zero is the base of all concrete addresses. */
+    typedef uint64_t CellKey;
+
+    /** List of memory cells. */
+    typedef std::list<MemoryCellPtr> CellList;
+
+    /** Set of concrete virtual addresses. */
+    typedef Sawyer::Container::Set<rose_addr_t> AddressSet;
+
+    /** Number of offsets stored in each page of the hash table. */
+    static const size_t CELLS_PER_PAGE = 256;
+
+protected:
+    // A memory cell and its serial number. Larger serial numbers were inserted more recently; zero means no cell.
+    struct Entry {
+        MemoryCellPtr cell;
+        uint64_t serial;
+
+        Entry()
+            : serial(0) {}
+
+        Entry(const MemoryCellPtr &cell, uint64_t serial)
+            : cell(cell), serial(serial) {}
+    };
+
+    // Cells for CELLS_PER_PAGE consecutive offsets having the same base. Entries are allocated only for the span of offsets
+    // that have been written, since most pages hold only a few cells.
+    struct Page {
+        CellKey base;
+        rose_addr_t pageNumber;
+        size_t nCells;
+        size_t firstIndex;                              // index within the page of entries[0]
+        std::vector<Entry> entries;
+
+        Page(CellKey base, rose_addr_t pageNumber)
+            : base(base), pageNumber(pageNumber), nCells(0), firstIndex(0) {}
+
+        // Entry for an index within the page, or null if none has been allocated.
+        const Entry* entryAt(size_t index) const {
+            return index >= firstIndex && index - firstIndex < entries.size() ? &entries[index - firstIndex] : NULL;
+        }
+
+        // Entry for an index within the page, allocating entries to cover the index if necessary.
+        Entry& allocateEntry(size_t index) {
+            if (entries.empty()) {
+                firstIndex = index;
+            } else if (index < firstIndex) {
+                entries.insert(entries.begin(), firstIndex - index, Entry());
+                firstIndex = index;
+            }
+            if (index - firstIndex >= entries.size())
+                entries.resize(index - firstIndex + 1);
+            return entries[index - firstIndex];
+        }
+    };
+
+    // Chronological record of the offsets written for one base. An entry is stale if the page table no longer has a cell with
+    // that serial number at that offset.
+    struct LogEntry {
+        uint64_t serial;
+        rose_addr_t offset;
+
+        LogEntry(uint64_t serial, rose_addr_t offset)
+            : serial(serial), offset(offset) {}
+    };
+
+    struct Region {
+        size_t nCells;                                  // number of cells in the page table having this base
+        uint64_t newest;                                // serial number of the most recent cell written with this base
+        std::vector<LogEntry> log;
+        std::list<CellKey>::iterator recency;           // position in recentRegions_
+
+        Region()
+            : nCells(0), newest(0) {}
+    };
+
+    typedef Sawyer::Container::Map<CellKey, Region> Regions;
+
+    std::vector<Page> pages_;                           // pages in the order they were created
+    std::vector<size_t> slots_;                         // open-addressing table; zero is empty, else one plus index into pages_
+    Regions regions_;                                   // per-base chronological logs
+    std::list<CellKey> recentRegions_;                  // region bases, most recently written first
+    std::list<Entry> sideCells_;                        // cells not in the page table, in reverse chronological order
+    size_t nIndexed_;                                   // number of cells stored in pages_
+    uint64_t nextSerial_;                               // serial number for the next inserted cell
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Serialization
+#ifdef ROSE_HAVE_BOOST_SERIALIZATION_LIB
+private:
+    friend class boost::serialization::access;
+
+    template<class S>
+    void save(S &s, const unsigned /*version*/) const {
+        s & BOOST_SERIALIZATION_BASE_OBJECT_NVP(MemoryCellState);
+        std::vector<MemoryCellPtr> cells;
+        BOOST_FOREACH (const Entry &entry, chronologicalEntries())
+            cells.push_back(entry.cell);
+        s & BOOST_SERIALIZATION_NVP(cells);
+    }
+
+    template<class S>
+    void load(S &s, const unsigned /*version*/) {
+        s & BOOST_SERIALIZATION_BASE_OBJECT_NVP(MemoryCellState);
+        std::vector<MemoryCellPtr> cells;
+        s & BOOST_SERIALIZATION_NVP(cells);
+        clearCells();
+        BOOST_FOREACH (const MemoryCellPtr &cell, cells)
+            indexCell(cell, nextSerial_++);
+    }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER();
+#endif
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Real constructors
+protected:
+    MemoryCellHash()                                    // for serialization
+        : nIndexed_(0), nextSerial_(1) {}
+
+    explicit MemoryCellHash(const MemoryCellPtr &protocell)
+        : MemoryCellState(protocell), nIndexed_(0), nextSerial_(1) {}
+
+    MemoryCellHash(const SValuePtr &addrProtoval, const SValuePtr &valProtoval)
+        : MemoryCellState(addrProtoval, valProtoval), nIndexed_(0), nextSerial_(1) {}
+
+    // deep-copy the cells so that modifying this new state does not modify the existing state
+    MemoryCellHash(const MemoryCellHash &other);
+
+private:
+    MemoryCellHash& operator=(MemoryCellHash&) /*delete*/;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Static allocating constructors
+public:
+    /** Instantiate a new prototypical memory state. This constructor uses the default type for the cell type (based on the
+     *  semantic domain). The prototypical values are usually the same (addresses and stored values are normally the same
+     *  type). */
+    static MemoryCellHashPtr instance(const SValuePtr &addrProtoval, const SValuePtr &valProtoval) {
+        return MemoryCellHashPtr(new MemoryCellHash(addrProtoval, valProtoval));
+    }
+
+    /** Instantiate a new memory state with prototypical memory cell. */
+    static MemoryCellHashPtr instance(const MemoryCellPtr &protocell) {
+        return MemoryCellHashPtr(new MemoryCellHash(protocell));
+    }
+
+    /** Instantiate a new copy of an existing memory state. */
+    static MemoryCellHashPtr instance(const MemoryCellHashPtr &other) {
+        return MemoryCellHashPtr(new MemoryCellHash(*other));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Virtual constructors
+public:
+    virtual MemoryStatePtr create(const SValuePtr &addrProtoval, const SValuePtr &valProtoval) const ROSE_OVERRIDE {
+        return instance(addrProtoval, valProtoval);
+    }
+
+    /** Virtual allocating constructor. */
+    virtual MemoryStatePtr create(const MemoryCellPtr &protocell) const {
+        return instance(protocell);
+    }
+
+    virtual MemoryStatePtr clone() const ROSE_OVERRIDE {
+        return MemoryStatePtr(new MemoryCellHash(*this));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Dynamic pointer casts
+public:
+    /** Promote a base memory state pointer to a BaseSemantics::MemoryCellHash pointer. The memory state @p m must have
+     *  a BaseSemantics::MemoryCellHash dynamic type. */
+    static MemoryCellHashPtr promote(const BaseSemantics::MemoryStatePtr &m) {
+        MemoryCellHashPtr retval = boost::dynamic_pointer_cast<MemoryCellHash>(m);
+        ASSERT_not_null(retval);
+        return retval;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Methods we inherited
+public:
+    virtual void clear() ROSE_OVERRIDE;
+    virtual bool merge(const MemoryStatePtr &other, RiscOperators *addrOps, RiscOperators *valOps) ROSE_OVERRIDE;
+    virtual std::vector<MemoryCellPtr> matchingCells(const MemoryCell::Predicate&) const ROSE_OVERRIDE;
+    virtual std::vector<MemoryCellPtr> leadingCells(const MemoryCell::Predicate&) const ROSE_OVERRIDE;
+    virtual void eraseMatchingCells(const MemoryCell::Predicate&) ROSE_OVERRIDE;
+    virtual void eraseLeadingCells(const MemoryCell::Predicate&) ROSE_OVERRIDE;
+    virtual void traverse(MemoryCell::Visitor&) ROSE_OVERRIDE;
+
+    /** Read a value from memory.
+     *
+     *  Same as @ref MemoryCellList::readMemory except the cells that may alias the address are found with @ref scan. */
+    virtual SValuePtr readMemory(const SValuePtr &address, const SValuePtr &dflt,
+                                 RiscOperators *addrOps, RiscOperators *valOps) ROSE_OVERRIDE;
+
+    virtual SValuePtr peekMemory(const SValuePtr &address, const SValuePtr &dflt,
+                                 RiscOperators *addrOps, RiscOperators *valOps) ROSE_OVERRIDE;
+
+    /** Write a value to memory.
+     *
+     *  Creates a new memory cell that replaces any existing cell having the same base and offset. A cell that cannot be
+     *  indexed replaces all side-list cells that must alias it. */
+    virtual void writeMemory(const SValuePtr &addr, const SValuePtr &value,
+                             RiscOperators *addrOps, RiscOperators *valOps) ROSE_OVERRIDE;
+
+    virtual void print(std::ostream&, Formatter&) const ROSE_OVERRIDE;
+
+    virtual MemoryCell::AddressSet getWritersUnion(const SValuePtr &addr, size_t nBits, RiscOperators *addrOps,
+                                                   RiscOperators *valOps) ROSE_OVERRIDE;
+
+    virtual MemoryCell::AddressSet getWritersIntersection(const SValuePtr &addr, size_t nBits, RiscOperators *addrOps,
+                                                          RiscOperators *valOps) ROSE_OVERRIDE;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Methods first declared at this level of the class hierarchy
+public:
+    /** Decompose an address into a base and offset.
+     *
+     *  Returns true and sets @p base and @p offset if the address can be indexed. The base implementation decomposes only
+     *  concrete addresses, giving them a base of zero. Subclasses may decompose other addresses as long as they follow the
+     *  aliasing rule described for this class, and they must never use a zero base for a non-concrete address. */
+    virtual bool decomposeAddress(const SValuePtr &address, CellKey &base /*out*/, rose_addr_t &offset /*out*/) const;
+
+    /** Find cells that might alias an address.
+     *
+     *  Returns the cells that may alias the specified address and size, in reverse chronological order, ending with the first
+     *  cell that must alias the address.  The @p mustAlias argument is set to true if such a cell was found. This is the same
+     *  list that @ref MemoryCellList::scan returns for a list containing the same cells in the same order. */
+    CellList scan(const SValuePtr &addr, size_t nBits, RiscOperators *addrOps, RiscOperators *valOps,
+                  bool &mustAlias /*out*/) const;
+
+    /** Merge two states without aliasing.
+     *
+     *  The @p other state is merged into this state without considering any aliasing. Returns true if this state changed,
+     *  false otherwise. */
+    bool mergeNoAliasing(const MemoryStatePtr &other, RiscOperators *addrOps, RiscOperators *valOps);
+
+    /** Merge two states with aliasing.
+     *
+     *  The @p other state is merged into this state while considering any aliasing. Returns true if this state changed,
+     *  false otherwise. */
+    bool mergeWithAliasing(const MemoryStatePtr &other, RiscOperators *addrOps, RiscOperators *valOps);
+
+    /** Predicate to determine whether all bytes are present.
+     *
+     *  Returns true if bytes at the specified address and the following consecutive addresses are all present in this
+     *  memory state. */
+    virtual bool isAllPresent(const SValuePtr &address, size_t nBytes, RiscOperators *addrOps, RiscOperators *valOps) const;
+
+    /** Number of cells stored in the state. */
+    size_t nCells() const { return nIndexed_ + sideCells_.size(); }
+
+    /** Number of cells stored in the side list rather than the page table. */
+    size_t nSideCells() const { return sideCells_.size(); }
+
+protected:
+    // Compute a new value by merging the specified cells.  If the cell list is empty return the specified default.
+    virtual SValuePtr mergeCellValues(const CellList &cells, const SValuePtr &dflt, RiscOperators *addrOps,
+                                      RiscOperators *valOps);
+
+    // Returns the union of all writers from the specified cells.
+    virtual AddressSet mergeCellWriters(const CellList &cells);
+
+    // Returns the union of all properties from the specified cells.
+    virtual InputOutputPropertySet mergeCellProperties(const CellList &cells);
+
+    // Adjust I/O properties in the specified cells to make it look like they were just read.
+    virtual void updateReadProperties(CellList &cells);
+
+    // Insert a new cell as the most recent. Its writers set is empty and its I/O properties will be READ, READ_BEFORE_WRITE,
+    // and READ_UNINITIALIZED.
+    virtual MemoryCellPtr insertReadCell(const SValuePtr &addr, const SValuePtr &value);
+
+    // Insert a new cell as the most recent.  The specified writers and I/O properties are used.
+    virtual MemoryCellPtr insertReadCell(const SValuePtr &addr, const SValuePtr &value,
+                                         const AddressSet &writers, const InputOutputPropertySet &props);
+
+    // Insert a cell as the most recent, replacing cells it occludes.
+    void insertCell(const MemoryCellPtr &cell, RiscOperators *addrOps);
+
+    // Insert a cell with the specified serial number without looking for occluded side-list cells.
+    void indexCell(const MemoryCellPtr &cell, uint64_t serial);
+
+    // Decompose the address of a one-byte cell, or return false if the cell belongs in the side list.
+    bool isIndexable(const MemoryCellPtr &cell, CellKey &base /*out*/, rose_addr_t &offset /*out*/) const;
+
+    // Find the page table entry for a base and offset, or null.
+    const Entry* findEntry(CellKey base, rose_addr_t offset) const;
+    Entry* findEntry(CellKey base, rose_addr_t offset);
+
+    // Find or create the page for a base and offset.
+    Page& findOrCreatePage(CellKey base, rose_addr_t offset);
+
+    // All cells ordered from oldest to newest.
+    std::vector<Entry> chronologicalEntries() const;
+
+    // Cells that might alias the specified address and size, newest first. This omits only those cells that cannot alias the
+    // address according to the decomposition rule, and is all cells when the address cannot be decomposed.
+    std::vector<Entry> candidateEntries(const SValuePtr &addr, size_t nBits) const;
+
+    // The most recent cell whose address must be equal to the specified address, or null.
+    MemoryCellPtr findMustEqual(const SValuePtr &addr, RiscOperators *addrOps) const;
+
+    // Rebuild recentRegions_ from the regions' newest serial numbers.
+    void rebuildRecency();
+
+    // Remove all cells without touching other state properties.
+    void clearCells();
+
+    // Remove stale entries from a region's log.
+    void compactLog(CellKey base, Region &region);
+
+private:
+    size_t slotIndex(CellKey base, rose_addr_t pageNumber) const;
+    void rehash(size_t nSlots);
+};
+
+} // namespace
+} // namespace
+} // namespace
+} // namespace
+
+#ifdef ROSE_HAVE_BOOST_SERIALIZATION_LIB
+BOOST_CLASS_EXPORT_KEY(Rose::BinaryAnalysis::InstructionSemantics2::BaseSemantics::MemoryCellHash);
+#endif
+
+#endif
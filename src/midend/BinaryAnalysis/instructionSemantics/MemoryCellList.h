@@ -7,6 +7,8 @@
 #include <boost/serialization/access.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
+#include <boost/serialization/list.hpp>
+#include <boost/serialization/split_member.hpp>
 
 namespace Rose {
 namespace BinaryAnalysis {
@@ -33,13 +35,21 @@ typedef boost::shared_ptr<class MemoryCellList> MemoryCellListPtr;
  *  for users to define their own subclasses and use them in the semantic framework.
  *
  *  This implementation stores memory cells in reverse chronological order: the most recently created cells appear at the
- *  beginning of the list.  Subclasses, of course, are free to reorder the list however they want. */
+ *  beginning of the list.  Subclasses, of course, are free to reorder the list however they want.
+ *
+ *  The cell list is copy-on-write. Cloning a MemoryCellList takes constant time because the clone shares the list with the
+ *  original. The first operation that changes either state's cells (writing, merging, erasing, or a read that inserts a cell or
+ *  changes a cell's I/O properties) gives that state its own deep copy of the cells. Reads and peeks that don't change
+ *  anything never copy the cells; they return a copy of a shared cell's value instead.
+ *
+ *  A state shares its list for as long as the list's reference count says another state holds it. Cloning never modifies the
+ *  original state, so several threads may clone the same state at once as long as none of them modifies it. */
 class MemoryCellList: public MemoryCellState {
 public:
     typedef std::list<MemoryCellPtr> CellList;          /**< List of memory cells. */
     typedef Sawyer::Container::Set<rose_addr_t> AddressSet; /**< Set of concrete virtual addresses. */
 protected:
-    CellList cells;                                     // list of cells in reverse chronological order
+    boost::shared_ptr<CellList> cells_;                 // cells in reverse chronological order; shared by clones until modified
     bool occlusionsErased_;                             // prune away old cells that are occluded by newer ones.
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -49,31 +59,41 @@ private:
     friend class boost::serialization::access;
 
     template<class S>
-    void serialize(S &s, const unsigned /*version*/) {
+    void save(S &s, const unsigned /*version*/) const {
+        const CellList &cells = *cells_;
+        s & BOOST_SERIALIZATION_BASE_OBJECT_NVP(MemoryCellState);
+        s & BOOST_SERIALIZATION_NVP(cells);
+        s & BOOST_SERIALIZATION_NVP(occlusionsErased_);
+    }
+
+    template<class S>
+    void load(S &s, const unsigned /*version*/) {
+        CellList cells;
         s & BOOST_SERIALIZATION_BASE_OBJECT_NVP(MemoryCellState);
         s & BOOST_SERIALIZATION_NVP(cells);
         s & BOOST_SERIALIZATION_NVP(occlusionsErased_);
+        cells_ = boost::shared_ptr<CellList>(new CellList(cells));
     }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER();
 #endif
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // Real constructors
 protected:
     MemoryCellList()                                    // for serialization
-        : occlusionsErased_(false) {}
+        : cells_(new CellList), occlusionsErased_(false) {}
 
     explicit MemoryCellList(const MemoryCellPtr &protocell)
-        : MemoryCellState(protocell), occlusionsErased_(false) {}
+        : MemoryCellState(protocell), cells_(new CellList), occlusionsErased_(false) {}
 
     MemoryCellList(const SValuePtr &addrProtoval, const SValuePtr &valProtoval)
-        : MemoryCellState(addrProtoval, valProtoval), occlusionsErased_(false) {}
+        : MemoryCellState(addrProtoval, valProtoval), cells_(new CellList), occlusionsErased_(false) {}
 
-    // deep-copy cell list so that modifying this new state does not modify the existing state
+    // Share the cell list with the other state. Whichever state modifies the list first makes its own deep copy, so modifying
+    // this new state does not modify the existing state.
     MemoryCellList(const MemoryCellList &other)
-        : MemoryCellState(other), occlusionsErased_(other.occlusionsErased_) {
-        for (CellList::const_iterator ci=other.cells.begin(); ci!=other.cells.end(); ++ci)
-            cells.push_back((*ci)->clone());
-    }
+        : MemoryCellState(other), cells_(other.cells_), occlusionsErased_(other.occlusionsErased_) {}
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // Static allocating constructors
@@ -213,7 +233,7 @@ public:
         ASSERT_not_null(addr);
         CellList retval;
         MemoryCellPtr tempCell = protocell->create(addr, valOps->undefined_(nBits));
-        for (/*void*/; cursor!=cells.end(); ++cursor) {
+        for (/*void*/; cursor!=cells_->end(); ++cursor) {
             if (tempCell->may_alias(*cursor, addrOps)) {
                 retval.push_back(*cursor);
                 if (tempCell->must_alias(*cursor, addrOps))
@@ -224,11 +244,22 @@ public:
     }
 
     /** Returns the list of all memory cells.
+     *
+     *  The non-const version first gives this state its own copy of the cells if they're shared with another state, so the
+     *  list and the cells it contains can be modified. The const version doesn't copy anything, and the cells it returns must
+     *  not be modified. Reads and peeks use the const version and copy the cells only if the read changes them.
+     *
      * @{ */
-    virtual const CellList& get_cells() const { return cells; }
-    virtual       CellList& get_cells()       { return cells; }
+    virtual const CellList& get_cells() const { return *cells_; }
+    virtual       CellList& get_cells()       { unshareCells(); return *cells_; }
     /** @} */
 
+    /** Whether the cell list is shared.
+     *
+     *  Returns true if some other state, such as one that was cloned from this state or from which this state was cloned, still
+     *  holds this state's cell list. */
+    bool cellsAreShared() const { return cells_.use_count() > 1; }
+
     virtual MemoryCell::AddressSet getWritersUnion(const SValuePtr &addr, size_t nBits, RiscOperators *addrOps,
                                                    RiscOperators *valOps) ROSE_OVERRIDE;
 
@@ -236,6 +267,9 @@ public:
                                                           RiscOperators *valOps) ROSE_OVERRIDE;
 
 protected:
+    // Give this state its own deep copy of the cell list if the list is shared with any other state.
+    void unshareCells();
+
     // Compute a new value by merging the specified cells.  If the cell list is empty return the specified default.
     virtual SValuePtr mergeCellValues(const CellList &cells, const SValuePtr &dflt, RiscOperators *addrOps,
                                       RiscOperators *valOps);
@@ -250,6 +284,9 @@ protected:
     // may also add READ_AFTER_WRITE, READ_BEFORE_WRITE, and/or READ_UNINITIALIZED.
     virtual void updateReadProperties(CellList &cells);
 
+    // True if updateReadProperties would change the I/O properties of any of the specified cells.
+    bool readPropertiesChange(const CellList &cells) const;
+
     // Insert a new cell at the head of the list. It's writers set is empty and its I/O properties will be READ,
     // READ_BEFORE_WRITE, and READ_UNINITIALIZED.
     virtual MemoryCellPtr insertReadCell(const SValuePtr &addr, const SValuePtr &value);
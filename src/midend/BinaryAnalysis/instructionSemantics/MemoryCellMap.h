@@ -5,10 +5,12 @@
 #include <boost/foreach.hpp>
 #include <MemoryCellState.h>
 #include <Sawyer/Map.h>
+#include <Sawyer/Set.h>
 
 #include <boost/serialization/access.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
+#include <boost/serialization/split_member.hpp>
 
 namespace Rose {
 namespace BinaryAnalysis {
@@ -23,7 +25,14 @@ typedef boost::shared_ptr<class MemoryCellMap> MemoryCellMapPtr;
  *  Memory cells (address + value pairs with additional data, @refMemoryCell) are stored in a map-like container so that a cell
  *  can be accessed in logarithmic time given its address.  The keys for the map are generated from the cell virtual addresses,
  *  either by using the address directly or by hashing it. The function that generates these keys, @ref generateCellKey, is
- *  pure virtual. */
+ *  pure virtual.
+ *
+ *  The cell map is copy-on-write. Cloning a MemoryCellMap takes constant time because the clone shares the map and its cells
+ *  with the original.  A state copies the map (but not the cells) the first time it inserts or erases a cell, and copies an
+ *  individual cell only when it needs to modify it. Reading a shared cell returns a copy of its value.
+ *
+ *  Whether the map or a cell is shared is decided from its reference count, so cloning never modifies the original state and
+ *  several threads may clone the same state at once as long as none of them modifies it. */
 class MemoryCellMap: public MemoryCellState {
 public:
     /** Key used to look up memory cells.
@@ -37,33 +46,43 @@ public:
     typedef Sawyer::Container::Map<CellKey, MemoryCellPtr> CellMap;
 
 protected:
-    CellMap cells;
+    boost::shared_ptr<CellMap> cells_;                  // cells, shared with clones until modified
 
 #ifdef ROSE_HAVE_BOOST_SERIALIZATION_LIB
 private:
     friend class boost::serialization::access;
 
     template<class S>
-    void serialize(S &s, const unsigned /*version*/) {
+    void save(S &s, const unsigned /*version*/) const {
+        const CellMap &cells = *cells_;
+        s & BOOST_SERIALIZATION_BASE_OBJECT_NVP(MemoryCellState);
+        s & BOOST_SERIALIZATION_NVP(cells);
+    }
+
+    template<class S>
+    void load(S &s, const unsigned /*version*/) {
+        CellMap cells;
         s & BOOST_SERIALIZATION_BASE_OBJECT_NVP(MemoryCellState);
         s & BOOST_SERIALIZATION_NVP(cells);
+        cells_ = boost::shared_ptr<CellMap>(new CellMap(cells));
     }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER();
 #endif
     
 protected:
-    MemoryCellMap() {}                                  // for serialization
+    MemoryCellMap()                                     // for serialization
+        : cells_(new CellMap) {}
 
     explicit MemoryCellMap(const MemoryCellPtr &protocell)
-        : MemoryCellState(protocell) {}
+        : MemoryCellState(protocell), cells_(new CellMap) {}
 
     MemoryCellMap(const SValuePtr &addrProtoval, const SValuePtr &valProtoval)
-        : MemoryCellState(addrProtoval, valProtoval) {}
+        : MemoryCellState(addrProtoval, valProtoval), cells_(new CellMap) {}
 
+    // Share the map and its cells with the other state. Each state copies the map and individual cells as it modifies them.
     MemoryCellMap(const MemoryCellMap &other)
-        : MemoryCellState(other) {
-        BOOST_FOREACH (const MemoryCellPtr &cell, other.cells.values())
-            cells.insert(other.generateCellKey(cell->get_address()), cell->clone());
-    }
+        : MemoryCellState(other), cells_(other.cells_) {}
 
 private:
     MemoryCellMap& operator=(MemoryCellMap&) /*delete*/;
@@ -91,7 +110,8 @@ public:
      *
      *  Returns the memory cell for the specified address, or a null pointer if the cell does not exist.  The address is used
      *  to look up the cell in logirithmic time. This is just a convenience wrapper around @ref matchingCells that returns
-     *  either the (single) cell found by that function or a null pointer. */
+     *  either the (single) cell found by that function or a null pointer.  The cell might be shared with clones of this state
+     *  and must not be modified. */
     virtual MemoryCellPtr findCell(const SValuePtr &addr) const;
 
     /** Predicate to determine whether all bytes are present.
@@ -119,6 +139,24 @@ public:
                                                    RiscOperators *valOps) ROSE_OVERRIDE;
     virtual MemoryCell::AddressSet getWritersIntersection(const SValuePtr &addr, size_t nBits, RiscOperators *addrOps,
                                                           RiscOperators *valOps) ROSE_OVERRIDE;
+
+protected:
+    /** Map that can be modified.
+     *
+     *  Returns the cell map after giving this state its own copy of the map if the map is shared with another state. The
+     *  copy shares the cells themselves, so use @ref mutableCell before modifying a cell. */
+    CellMap& mutableCells();
+
+    /** Cell that can be modified.
+     *
+     *  Returns the cell stored for the specified key, or null if there is none. If the cell is shared with any other state
+     *  then it's first replaced by a copy that belongs only to this state. */
+    MemoryCellPtr mutableCell(CellKey);
+
+private:
+    // Whether a cell stored in this state's map might also belong to another state. The argument must be the pointer stored
+    // in the map, not a copy, since every copy counts as a reference.
+    bool cellIsShared(const MemoryCellPtr &stored) const;
 };
 
 } // namespace
@@ -62,6 +62,9 @@ public:
 
 public:
     /** Property: Cell most recently written.
+     *
+     *  Memory states may share cells with their clones, so the returned cell should be modified only before this state is
+     *  next cloned, such as immediately after the write that created it.
      *
      * @{ */
     virtual MemoryCellPtr latestWrittenCell() const {
@@ -6,6 +6,7 @@
 #include <boost/serialization/access.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
+#include <boost/serialization/split_member.hpp>
 
 namespace Rose {
 namespace BinaryAnalysis {
@@ -116,6 +117,15 @@ public:
     /** Values for all registers. */
     typedef Sawyer::Container::Map<RegStore, RegPairs> Registers;
 
+    /** Shared-ownership pointer to the register/value pairs for one major/minor pair.
+     *
+     *  A pair list is shared by a register state and its clones until one of them needs to modify the list or its values, at
+     *  which time that state makes its own copy of the list and the values. */
+    typedef boost::shared_ptr<RegPairs> RegPairsPtr;
+
+    /** Shared pair lists for all registers. */
+    typedef Sawyer::Container::Map<RegStore, RegPairsPtr> SharedRegisters;
+
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //                                  Types for Boolean properties
@@ -152,8 +162,8 @@ public:
     //                                  Data members
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 private:
-    RegisterProperties properties_;                     // Boolean properties for each bit of each register.
-    RegisterAddressSet writers_;                        // Writing instruction address set for each bit of each register
+    boost::shared_ptr<RegisterProperties> properties_;  // Boolean properties for each bit of each register (copy-on-write)
+    boost::shared_ptr<RegisterAddressSet> writers_;     // Writing instruction addresses for each bit of each reg (copy-on-write)
     bool accessModifiesExistingLocations_;              // Can read/write modify existing locations?
     bool accessCreatesLocations_;                       // Can new locations be created?
 
@@ -165,8 +175,12 @@ protected:
      *  overlap only with those registers on the matching major-minor list, if it overlaps at all.  The lists are typically
      *  short (e.g., one list might refer to all the parts of the x86 RAX register, but the RBX parts would be on a different
      *  list. None of the registers stored on a particular list overlap with any other register on that same list; when adding
-     *  new register that would overlap, the registers with which it overlaps must be removed first. */
-    Registers registers_;
+     *  new register that would overlap, the registers with which it overlaps must be removed first.
+     *
+     *  The map and each of its pair lists are copy-on-write: cloning a register state shares them with the original, and
+     *  they're copied only when one of the states modifies them. Use @ref storedPairs to look at a pair list and @ref
+     *  mutablePairs to obtain a list that can be modified. */
+    boost::shared_ptr<SharedRegisters> registers_;
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //                                  Serialization
@@ -176,14 +190,39 @@ private:
     friend class boost::serialization::access;
 
     template<class S>
-    void serialize(S &s, const unsigned /*version*/) {
+    void save(S &s, const unsigned /*version*/) const {
+        RegisterProperties properties = *properties_;
+        RegisterAddressSet writers = *writers_;
+        Registers registers;
+        BOOST_FOREACH (const SharedRegisters::Node &node, registers_->nodes())
+            registers.insert(node.key(), *node.value());
         s & BOOST_SERIALIZATION_BASE_OBJECT_NVP(RegisterState);
-        s & BOOST_SERIALIZATION_NVP(properties_);
-        s & BOOST_SERIALIZATION_NVP(writers_);
+        s & boost::serialization::make_nvp("properties_", properties);
+        s & boost::serialization::make_nvp("writers_", writers);
         s & BOOST_SERIALIZATION_NVP(accessModifiesExistingLocations_);
         s & BOOST_SERIALIZATION_NVP(accessCreatesLocations_);
-        s & BOOST_SERIALIZATION_NVP(registers_);
+        s & boost::serialization::make_nvp("registers_", registers);
     }
+
+    template<class S>
+    void load(S &s, const unsigned /*version*/) {
+        RegisterProperties properties;
+        RegisterAddressSet writers;
+        Registers registers;
+        s & BOOST_SERIALIZATION_BASE_OBJECT_NVP(RegisterState);
+        s & boost::serialization::make_nvp("properties_", properties);
+        s & boost::serialization::make_nvp("writers_", writers);
+        s & BOOST_SERIALIZATION_NVP(accessModifiesExistingLocations_);
+        s & BOOST_SERIALIZATION_NVP(accessCreatesLocations_);
+        s & boost::serialization::make_nvp("registers_", registers);
+        properties_ = boost::shared_ptr<RegisterProperties>(new RegisterProperties(properties));
+        writers_ = boost::shared_ptr<RegisterAddressSet>(new RegisterAddressSet(writers));
+        registers_ = boost::shared_ptr<SharedRegisters>(new SharedRegisters);
+        BOOST_FOREACH (const Registers::Node &node, registers.nodes())
+            registers_->insert(node.key(), RegPairsPtr(new RegPairs(node.value())));
+    }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER();
 #endif
     
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -193,19 +232,21 @@ private:
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 protected:
     RegisterStateGeneric()                              // for serialization
-        : accessModifiesExistingLocations_(true), accessCreatesLocations_(true) {}
+        : properties_(new RegisterProperties), writers_(new RegisterAddressSet), accessModifiesExistingLocations_(true),
+          accessCreatesLocations_(true), registers_(new SharedRegisters) {}
 
     explicit RegisterStateGeneric(const SValuePtr &protoval, const RegisterDictionary *regdict)
-        : RegisterState(protoval, regdict), accessModifiesExistingLocations_(true), accessCreatesLocations_(true) {
+        : RegisterState(protoval, regdict), properties_(new RegisterProperties), writers_(new RegisterAddressSet),
+          accessModifiesExistingLocations_(true), accessCreatesLocations_(true), registers_(new SharedRegisters) {
         clear();
     }
 
+    // The copy shares all storage with the original; each of them copies a part of the storage when it first modifies it.
+    // Whether a part is shared is decided by its reference count, so the original is not modified.
     RegisterStateGeneric(const RegisterStateGeneric &other)
         : RegisterState(other), properties_(other.properties_), writers_(other.writers_),
           accessModifiesExistingLocations_(other.accessModifiesExistingLocations_),
-          accessCreatesLocations_(other.accessCreatesLocations_), registers_(other.registers_) {
-        deep_copy_values();
-    }
+          accessCreatesLocations_(other.accessCreatesLocations_), registers_(other.registers_) {}
 
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -222,7 +263,10 @@ public:
         return RegisterStateGenericPtr(new RegisterStateGeneric(protoval, regdict));
     }
 
-    /** Instantiate a new copy of an existing register state. */
+    /** Instantiate a new copy of an existing register state.
+     *
+     *  The copy is made in constant time: the new state shares the register values with the original, and a value is copied
+     *  only when the state that's using it reads, writes, or erases the register that contains it. */
     static RegisterStateGenericPtr instance(const RegisterStateGenericPtr &other) {
         return RegisterStateGenericPtr(new RegisterStateGeneric(*other));
     }
@@ -367,7 +411,9 @@ public:
      *  flag (bit 6 of EFLAGS) then the return value will contain a register/value pair for ZF, and also a pair for bits 0-5,
      *  and a pair for bits 7-31, neither of which correspond to actual register names in x86 (there is no name for bits 0-5 as
      *  a whole). The @ref readRegister and @ref writeRegister methods can be used to re-cast the various pairs into other
-     *  groupings; @ref get_stored_registers is a lower-level interface. */
+     *  groupings; @ref get_stored_registers is a lower-level interface.
+     *
+     *  The returned values might be shared with clones of this state and must not be modified. */
     virtual RegPairs get_stored_registers() const;
 
     /** Determines if some of the specified register is stored in the state. Returns true even if only part of the requested
@@ -402,7 +448,8 @@ public:
     /** Find stored registers overlapping with specified register.
      *
      *  Returns all stored registers that overlap with the specified register.  The registers in the returned vector will never
-     *  overlap with each other, but they will all overlap with the specified register. */
+     *  overlap with each other, but they will all overlap with the specified register.  The returned values might be shared
+     *  with clones of this state and must not be modified. */
     virtual RegPairs overlappingRegisters(RegisterDescriptor) const;
 
     /** Cause a register to not be stored.  Erases all record of the specified register. The RiscOperators pointer is used for
@@ -596,8 +643,33 @@ public:
     //                                  Non-public APIs
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 protected:
+    // Give this state its own copy of every register value, whether or not the values are shared with other states.
     void deep_copy_values();
 
+    /** Pair list for a register.
+     *
+     *  Returns the register/value pairs stored for the major and minor numbers of the specified register, or an empty list if
+     *  there are none. The list might be shared with other register states, so neither the list nor its values may be
+     *  modified. */
+    const RegPairs& storedPairs(RegStore) const;
+
+    /** Modifiable pair list for a register.
+     *
+     *  Returns the register/value pairs stored for the major and minor numbers of the specified register, creating an empty
+     *  list if necessary.  If the list is shared with any other register state then this state first makes its own copy of the
+     *  list and of its values, so the caller may modify both without affecting other states. The returned reference is valid
+     *  until this state is next cloned. */
+    RegPairs& mutablePairs(RegStore);
+
+    /** Make all pair lists modifiable.
+     *
+     *  This is the same as calling @ref mutablePairs for every stored register. */
+    void unshareRegisters();
+
+    // Properties and writers that can be modified, copying them first if they're shared with another register state.
+    RegisterProperties& mutableProperties();
+    RegisterAddressSet& mutableWriters();
+
     // Given a register descriptor return information about what's stored in the state. The two return values are:
     //
     //     accessedParts represent the parts of the reigster (matching major and minor numbers) that are present in the
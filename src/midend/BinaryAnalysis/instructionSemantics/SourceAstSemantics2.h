@@ -65,7 +65,7 @@ typedef Sawyer::SharedPointer<class SValue> SValuePtr;
  *  pointed to by an SValue. But never fear, the SValue's AST will be fixed by the time whole function ASTs are generated. */
 class SValue: public BaseSemantics::SValue {
 protected:
-    static size_t nVariables_;
+    static SAWYER_THREAD_LOCAL size_t nVariables_;     // thread-local so each thread can generate code independently
     std::string ctext_;
 
 protected:
@@ -98,6 +98,16 @@ public:
         return SValuePtr(new SValue(nbits, value));
     }
 
+    /** Restart the numbering of variables.
+     *
+     *  Each undefined value is a C variable named "V_" followed by a number that's unique within the calling thread. Resetting
+     *  the numbering before generating code for some unit, such as a basic block, makes the generated code for that unit
+     *  independent of what was generated earlier. The caller must ensure that variables from before the reset are not in
+     *  scope for code generated after the reset. */
+    static void resetVariableNumbering() {
+        nVariables_ = 0;
+    }
+
 public:
     virtual BaseSemantics::SValuePtr bottom_(size_t nbits) const ROSE_OVERRIDE {
         return instance_undefined(nbits);
@@ -11,6 +11,7 @@
 #include "BinarySmtSolver.h"
 #include "BinarySymbolicExpr.h"
 #include "RegisterStateGeneric.h"
+#include "MemoryCellHash.h"
 #include "MemoryCellList.h"
 #include "MemoryCellMap.h"
 
@@ -733,6 +734,158 @@ public:
 
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//                                      Hash-based Memory state
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/** Shared-ownership pointer to symbolic hash-based memory state. See @ref heap_object_shared_ownership. */
+typedef boost::shared_ptr<class MemoryHashState> MemoryHashStatePtr;
+
+/** Byte-addressable memory.
+ *
+ *  This class represents an entire state of memory the same way as @ref MemoryListState with occlusions erased, giving the
+ *  same results for reads, writes, and merges, but it finds the cells that might alias an address without scanning all the
+ *  cells.  Addresses that are constants, variables, or a variable plus a constant (such as stack addresses "esp_0 - 12")
+ *  are indexed by variable and offset; these are the addresses for which the symbolic expression layer decides aliasing
+ *  without an SMT solver.  Reading such an address looks only at the cell with the same variable and offset and at cells
+ *  with other variables that were written more recently.  Cells at all other addresses are kept in a side list that is
+ *  scanned like the list-based state.
+ *
+ *  No addresses other than constants are indexed while a SymbolicExpr::Node::mayEqualCallback is installed since the
+ *  callback may change the aliasing rules.
+ *
+ *  @sa MemoryListState, MemoryMapState */
+class MemoryHashState: public BaseSemantics::MemoryCellHash {
+public:
+    typedef BaseSemantics::MemoryCellHash Super;
+
+protected:
+    MemoryListState::CellCompressor *cell_compressor;   /**< Callback when a memory read aliases multiple memory cells. */
+    static MemoryListState::CellCompressorChoice cc_choice; /**< The default cell compressor. */
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Serialization
+#ifdef ROSE_HAVE_BOOST_SERIALIZATION_LIB
+private:
+    friend class boost::serialization::access;
+
+    template<class S>
+    void serialize(S &s, const unsigned /*version*/) {
+        s & BOOST_SERIALIZATION_BASE_OBJECT_NVP(Super);
+    }
+#endif
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Real constructors
+protected:
+    MemoryHashState()                                   // for serialization
+        : cell_compressor(&cc_choice) {}
+
+    explicit MemoryHashState(const BaseSemantics::MemoryCellPtr &protocell)
+        : BaseSemantics::MemoryCellHash(protocell), cell_compressor(&cc_choice) {}
+
+    MemoryHashState(const BaseSemantics::SValuePtr &addrProtoval, const BaseSemantics::SValuePtr &valProtoval)
+        : BaseSemantics::MemoryCellHash(addrProtoval, valProtoval), cell_compressor(&cc_choice) {}
+
+    MemoryHashState(const MemoryHashState &other)
+        : BaseSemantics::MemoryCellHash(other), cell_compressor(other.cell_compressor) {}
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Static allocating constructors
+public:
+    /** Instantiates a new memory state having specified prototypical cells and value. */
+    static MemoryHashStatePtr instance(const BaseSemantics::MemoryCellPtr &protocell) {
+        return MemoryHashStatePtr(new MemoryHashState(protocell));
+    }
+
+    /** Instantiates a new memory state having specified prototypical value.  This constructor uses BaseSemantics::MemoryCell
+     *  as the cell type. */
+    static MemoryHashStatePtr instance(const BaseSemantics::SValuePtr &addrProtoval,
+                                       const BaseSemantics::SValuePtr &valProtoval) {
+        return MemoryHashStatePtr(new MemoryHashState(addrProtoval, valProtoval));
+    }
+
+    /** Instantiates a new deep copy of an existing state. */
+    static MemoryHashStatePtr instance(const MemoryHashStatePtr &other) {
+        return MemoryHashStatePtr(new MemoryHashState(*other));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Virtual constructors
+public:
+    /** Virtual constructor. Creates a memory state having specified prototypical value.  This constructor uses
+     * BaseSemantics::MemoryCell as the cell type. */
+    virtual BaseSemantics::MemoryStatePtr create(const BaseSemantics::SValuePtr &addrProtoval,
+                                                 const BaseSemantics::SValuePtr &valProtoval) const ROSE_OVERRIDE {
+        return instance(addrProtoval, valProtoval);
+    }
+
+    /** Virtual constructor. Creates a new memory state having specified prototypical cells and value. */
+    virtual BaseSemantics::MemoryStatePtr create(const BaseSemantics::MemoryCellPtr &protocell) const ROSE_OVERRIDE {
+        return instance(protocell);
+    }
+
+    /** Virtual copy constructor. Creates a new deep copy of this memory state. */
+    virtual BaseSemantics::MemoryStatePtr clone() const ROSE_OVERRIDE {
+        return BaseSemantics::MemoryStatePtr(new MemoryHashState(*this));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Dynamic pointer casts
+public:
+    /** Recasts a base pointer to a symbolic memory state. This is a checked cast that will fail if the specified pointer does
+     *  not have a run-time type that is a SymbolicSemantics::MemoryHashState or subclass thereof. */
+    static MemoryHashStatePtr promote(const BaseSemantics::MemoryStatePtr &x) {
+        MemoryHashStatePtr retval = boost::dynamic_pointer_cast<MemoryHashState>(x);
+        ASSERT_not_null(retval);
+        return retval;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Methods we inherited
+public:
+    /** Read a byte from memory.
+     *
+     *  In order to read a multi-byte value, use RiscOperators::readMemory(). */
+    virtual BaseSemantics::SValuePtr readMemory(const BaseSemantics::SValuePtr &addr, const BaseSemantics::SValuePtr &dflt,
+                                                BaseSemantics::RiscOperators *addrOps,
+                                                BaseSemantics::RiscOperators *valOps) ROSE_OVERRIDE;
+
+    /** Read a byte from memory with no side effects.
+     *
+     *  In order to read a multi-byte value, use RiscOperators::peekMemory(). */
+    virtual BaseSemantics::SValuePtr peekMemory(const BaseSemantics::SValuePtr &addr, const BaseSemantics::SValuePtr &dflt,
+                                                BaseSemantics::RiscOperators *addrOps,
+                                                BaseSemantics::RiscOperators *valOps) ROSE_OVERRIDE;
+
+    /** Write a byte to memory.
+     *
+     *  In order to write a multi-byte value, use RiscOperators::writeMemory(). */
+    virtual void writeMemory(const BaseSemantics::SValuePtr &addr, const BaseSemantics::SValuePtr &value,
+                             BaseSemantics::RiscOperators *addrOps, BaseSemantics::RiscOperators *valOps) ROSE_OVERRIDE;
+
+    virtual bool decomposeAddress(const BaseSemantics::SValuePtr &address, CellKey &base /*out*/,
+                                  rose_addr_t &offset /*out*/) const ROSE_OVERRIDE;
+
+protected:
+    BaseSemantics::SValuePtr readOrPeekMemory(const BaseSemantics::SValuePtr &address,
+                                              const BaseSemantics::SValuePtr &dflt,
+                                              BaseSemantics::RiscOperators *addrOps,
+                                              BaseSemantics::RiscOperators *valOps,
+                                              bool allowSideEffects);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Methods first declared in this class
+public:
+    /** Callback for handling a memory read whose address matches more than one memory cell.  See also @ref
+     *  MemoryListState::get_cell_compressor.
+     * @{ */
+    MemoryListState::CellCompressor* get_cell_compressor() const { return cell_compressor; }
+    void set_cell_compressor(MemoryListState::CellCompressor *cc) { cell_compressor = cc; }
+    /** @} */
+};
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //                                      Default memory state
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1187,6 +1340,7 @@ protected:
 BOOST_CLASS_EXPORT_KEY(Rose::BinaryAnalysis::InstructionSemantics2::SymbolicSemantics::SValue);
 BOOST_CLASS_EXPORT_KEY(Rose::BinaryAnalysis::InstructionSemantics2::SymbolicSemantics::MemoryListState);
 BOOST_CLASS_EXPORT_KEY(Rose::BinaryAnalysis::InstructionSemantics2::SymbolicSemantics::MemoryMapState);
+BOOST_CLASS_EXPORT_KEY(Rose::BinaryAnalysis::InstructionSemantics2::SymbolicSemantics::MemoryHashState);
 BOOST_CLASS_EXPORT_KEY(Rose::BinaryAnalysis::InstructionSemantics2::SymbolicSemantics::RiscOperators);
 #endif
 
@@ -0,0 +1,187 @@
+// Classes for task-parallel evaluation of a single top-down and/or bottom-up traversal.
+
+#ifndef ASTTASKPARALLELPROCESSING_H
+#define ASTTASKPARALLELPROCESSING_H
+
+#include "AstProcessing.h"
+
+#include <Sawyer/Synchronization.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+// The AstSharedMemoryParallel*Processing classes run several different traversals side by side, one per thread, which
+// doesn't help when there is only one expensive traversal. The classes in this file instead split one traversal of one AST
+// into tasks: every subtree that has at least a certain number of nodes (the subtree size threshold) evaluates the
+// attributes of its root and then hands each of its children's subtrees to a separate task. Smaller subtrees are traversed
+// serially within their task. Tasks are scheduled on a work-stealing pool, and the synthesized attributes of each node's
+// children are combined in the same order as in a serial traversal.
+//
+// Since the evaluate functions run concurrently on different nodes, they must be thread-safe. They are called for the same
+// nodes, with the same attributes, as by the serial traversal, but not in the same order. Call traverseInParallel() instead
+// of traverse() to run in parallel; calling traverse() still runs serially. Unlike traverse(), traverseInParallel() always
+// uses the default traversal successors of each node and cannot be restricted to a single file. Multi-threading must be
+// enabled (e.g., g++ -pthread); otherwise the tasks run one after another on the calling thread.
+
+// Work-stealing pool of threads that run the tasks of a task-parallel traversal. Each worker has a queue of tasks. Tasks
+// spawned by a worker are added to the back of that worker's queue, and each worker takes tasks from the back of its own
+// queue, or, when that is empty, steals them from the front of another worker's queue.
+class ROSE_DLL_API AstTaskParallelWorkPool
+{
+public:
+    class Task
+    {
+    public:
+        virtual ~Task() {}
+
+        // Runs the task in the specified worker of the pool. The task may spawn more tasks in the same worker.
+        virtual void run(AstTaskParallelWorkPool &pool, size_t worker) = 0;
+    };
+
+    // A pool whose run() uses the calling thread and numberOfThreads-1 additional threads. Zero means use one thread per
+    // hardware processor.
+    explicit AstTaskParallelWorkPool(size_t numberOfThreads);
+    ~AstTaskParallelWorkPool();
+
+    size_t get_numberOfThreads() const;
+
+    // Runs the task and all tasks it spawns, directly or indirectly, and returns when they have all finished. The pool
+    // deletes each task after running it. If a task throws an exception, the remaining tasks are deleted without being run
+    // and this function throws an std::runtime_error with the same message.
+    void run(Task *task);
+
+    // Queues a task to be run. This should only be called by a task running in the specified worker.
+    void spawn(size_t worker, Task *task);
+
+private:
+    struct Queue
+    {
+        SAWYER_THREAD_TRAITS::Mutex mutex;
+        std::deque<Task*> tasks;
+    };
+
+    void work(size_t worker);
+    Task *take(size_t worker);
+    void finish(Task *task, const std::string *taskError);
+
+    // Not implemented
+    AstTaskParallelWorkPool(const AstTaskParallelWorkPool&);
+    AstTaskParallelWorkPool &operator=(const AstTaskParallelWorkPool&);
+
+    std::vector<Queue*> queues;
+    SAWYER_THREAD_TRAITS::Mutex mutex;                  // protects the following data members
+#if SAWYER_MULTI_THREADED
+    boost::condition_variable_any workChanged;          // signaled when tasks are queued or all tasks are finished
+#endif
+    size_t numberOfQueuedTasks;                         // tasks that are in a queue
+    size_t numberOfUnfinishedTasks;                     // tasks that are queued or running
+    bool failed;                                        // whether a task has thrown an exception
+    std::string error;                                  // message from the first exception
+};
+
+// Base class holding the code that is the same for all the task-parallel processing classes. I is the inherited
+// attribute type and S is the synthesized attribute type. The concrete classes map the three evaluate functions to their
+// own evaluate functions.
+template <class I, class S>
+class AstTaskParallelProcessingBase
+{
+public:
+    typedef typename SgTreeTraversal<I, S>::SynthesizedAttributesList SynthesizedAttributesList;
+
+    AstTaskParallelProcessingBase();
+    virtual ~AstTaskParallelProcessingBase() {}
+
+    // Number of threads used by traverseInParallel(), or zero (the default) for one thread per hardware processor.
+    void set_numberOfThreads(size_t threads);
+    size_t get_numberOfThreads() const;
+
+    // Subtrees with fewer nodes than this are traversed serially by one task. The default is 1000 nodes. Small values make
+    // more tasks, which balance the load better but cost more to schedule.
+    void set_subtreeSizeThreshold(size_t threshold);
+    size_t get_subtreeSizeThreshold() const;
+
+protected:
+    // Evaluates all attributes in the AST rooted at basenode and returns the synthesized attribute of basenode.
+    S traverseTasks(SgNode *basenode, I inheritedValue);
+
+private:
+    virtual I taskEvaluateInheritedAttribute(SgNode *astNode, I inheritedValue) = 0;
+    virtual S taskEvaluateSynthesizedAttribute(SgNode *astNode, I inheritedValue, SynthesizedAttributesList l) = 0;
+    virtual S taskDefaultSynthesizedAttribute(I inheritedValue) = 0;
+
+    struct Join;
+    struct Context;
+    class RootTask;
+    class SubtreeTask;
+
+    size_t countNodes(SgNode *node, Context &context);
+    void traverseSubtree(AstTaskParallelWorkPool &pool, SgNode *node, I inheritedValue, Join *parent, size_t index,
+                         Context &context, size_t worker);
+    S traverseSerially(SgNode *node, I inheritedValue);
+    void performSerialTraversal(SgNode *node, I inheritedValue, SynthesizedAttributesList &stack);
+    void deliver(Join *join, size_t index, S value, Context &context);
+
+    size_t numberOfThreads;
+    size_t subtreeSizeThreshold;
+};
+
+// TOP DOWN BOTTOM UP task-parallel traversal. This is used like AstTopDownBottomUpProcessing, except that the evaluate
+// functions must be thread-safe and traverseInParallel() runs the traversal in parallel.
+template <class InheritedAttributeType, class SynthesizedAttributeType>
+class AstTaskParallelTopDownBottomUpProcessing
+    : public AstTopDownBottomUpProcessing<InheritedAttributeType, SynthesizedAttributeType>,
+      public AstTaskParallelProcessingBase<InheritedAttributeType, SynthesizedAttributeType>
+{
+public:
+    typedef AstTopDownBottomUpProcessing<InheritedAttributeType, SynthesizedAttributeType> Superclass;
+    typedef typename Superclass::SynthesizedAttributesList SynthesizedAttributesList;
+
+    SynthesizedAttributeType traverseInParallel(SgNode *basenode, InheritedAttributeType inheritedValue);
+
+private:
+    virtual InheritedAttributeType taskEvaluateInheritedAttribute(SgNode *, InheritedAttributeType);
+    virtual SynthesizedAttributeType taskEvaluateSynthesizedAttribute(SgNode *, InheritedAttributeType, SynthesizedAttributesList);
+    virtual SynthesizedAttributeType taskDefaultSynthesizedAttribute(InheritedAttributeType);
+};
+
+// TOP DOWN task-parallel traversal. This is used like AstTopDownProcessing, except that evaluateInheritedAttribute() and
+// destroyInheritedValue() must be thread-safe and traverseInParallel() runs the traversal in parallel.
+template <class InheritedAttributeType>
+class AstTaskParallelTopDownProcessing
+    : public AstTopDownProcessing<InheritedAttributeType>,
+      public AstTaskParallelProcessingBase<InheritedAttributeType, DummyAttribute>
+{
+public:
+    typedef AstTopDownProcessing<InheritedAttributeType> Superclass;
+    typedef typename Superclass::SynthesizedAttributesList SynthesizedAttributesList;
+
+    void traverseInParallel(SgNode *basenode, InheritedAttributeType inheritedValue);
+
+private:
+    virtual InheritedAttributeType taskEvaluateInheritedAttribute(SgNode *, InheritedAttributeType);
+    virtual DummyAttribute taskEvaluateSynthesizedAttribute(SgNode *, InheritedAttributeType, SynthesizedAttributesList);
+    virtual DummyAttribute taskDefaultSynthesizedAttribute(InheritedAttributeType);
+};
+
+// BOTTOM UP task-parallel traversal. This is used like AstBottomUpProcessing, except that evaluateSynthesizedAttribute()
+// and defaultSynthesizedAttribute() must be thread-safe and traverseInParallel() runs the traversal in parallel.
+template <class SynthesizedAttributeType>
+class AstTaskParallelBottomUpProcessing
+    : public AstBottomUpProcessing<SynthesizedAttributeType>,
+      public AstTaskParallelProcessingBase<DummyAttribute, SynthesizedAttributeType>
+{
+public:
+    typedef AstBottomUpProcessing<SynthesizedAttributeType> Superclass;
+    typedef typename Superclass::SynthesizedAttributesList SynthesizedAttributesList;
+
+    SynthesizedAttributeType traverseInParallel(SgNode *basenode);
+
+private:
+    virtual DummyAttribute taskEvaluateInheritedAttribute(SgNode *, DummyAttribute);
+    virtual SynthesizedAttributeType taskEvaluateSynthesizedAttribute(SgNode *, DummyAttribute, SynthesizedAttributesList);
+    virtual SynthesizedAttributeType taskDefaultSynthesizedAttribute(DummyAttribute);
+};
+
+#include "AstTaskParallelProcessingImpl.h"
+
+#endif
@@ -0,0 +1,433 @@
+// Template implementation of the task-parallel processing classes; included by AstTaskParallelProcessing.h.
+
+#ifndef ASTTASKPARALLELPROCESSINGIMPL_H
+#define ASTTASKPARALLELPROCESSINGIMPL_H
+
+#include <boost/unordered_map.hpp>
+
+/////////////////////////////////////////////////
+//// TASK-PARALLEL PROCESSING IMPLEMENTATION ////
+/////////////////////////////////////////////////
+
+// The synthesized attributes of the children of a node whose subtree was split into tasks. The pending count is the number
+// of children whose attribute hasn't arrived yet; the task that delivers the last one evaluates the node's synthesized
+// attribute and delivers it to the join of the node's parent.
+template <class I, class S>
+struct AstTaskParallelProcessingBase<I, S>::Join
+{
+    Join(SgNode *node, I inheritedValue, size_t numberOfSuccessors, Join *parent, size_t index)
+        : node(node), inheritedValue(inheritedValue), results(numberOfSuccessors), pending(numberOfSuccessors),
+          parent(parent), index(index) {}
+
+    SgNode *node;
+    I inheritedValue;                                   // inherited attribute evaluated for node
+    std::vector<S> results;                             // protected by mutex
+    size_t pending;                                     // protected by mutex
+    SAWYER_THREAD_TRAITS::Mutex mutex;
+    Join *parent;                                       // NULL if node is the root of the traversal
+    size_t index;                                       // which successor of the parent's node this node is
+};
+
+// State shared by all tasks of one traversal.
+template <class I, class S>
+struct AstTaskParallelProcessingBase<I, S>::Context
+{
+    Context(): result() {}
+
+    // Sizes of the subtrees that are split into tasks and of their successors' subtrees; no other subtree is in the map. It
+    // is only modified before the tasks start.
+    boost::unordered_map<SgNode*, size_t> sizes;
+    std::vector<size_t> successorSizes;                 // scratch space for counting the nodes
+
+    SAWYER_THREAD_TRAITS::Mutex mutex;                  // protects joins
+    std::vector<Join*> joins;                           // deleted when the traversal is done
+    S result;                                           // synthesized attribute of the root
+};
+
+// Traverses the whole AST.
+template <class I, class S>
+class AstTaskParallelProcessingBase<I, S>::RootTask: public AstTaskParallelWorkPool::Task
+{
+public:
+    RootTask(AstTaskParallelProcessingBase<I, S> *processing, SgNode *node, I inheritedValue, Context &context)
+        : processing(processing), node(node), inheritedValue(inheritedValue), context(context) {}
+
+    void run(AstTaskParallelWorkPool &pool, size_t worker)
+    {
+        processing->traverseSubtree(pool, node, inheritedValue, NULL, 0, context, worker);
+    }
+
+private:
+    AstTaskParallelProcessingBase<I, S> *processing;
+    SgNode *node;
+    I inheritedValue;
+    Context &context;
+};
+
+// Traverses the subtrees of successors begin through end-1 of the node of a join.
+template <class I, class S>
+class AstTaskParallelProcessingBase<I, S>::SubtreeTask: public AstTaskParallelWorkPool::Task
+{
+public:
+    SubtreeTask(AstTaskParallelProcessingBase<I, S> *processing, Join *join, size_t begin, size_t end, Context &context)
+        : processing(processing), join(join), begin(begin), end(end), context(context) {}
+
+    void run(AstTaskParallelWorkPool &pool, size_t worker)
+    {
+        for (size_t idx = begin; idx < end; idx++)
+        {
+            SgNode *child = join->node->get_traversalSuccessorByIndex(idx);
+            if (child != NULL)
+            {
+                processing->traverseSubtree(pool, child, join->inheritedValue, join, idx, context, worker);
+            }
+            else
+            {
+                // null pointer (not traversed): the default value takes its place, as in a serial traversal
+                processing->deliver(join, idx, processing->taskDefaultSynthesizedAttribute(join->inheritedValue), context);
+            }
+        }
+    }
+
+private:
+    AstTaskParallelProcessingBase<I, S> *processing;
+    Join *join;
+    size_t begin, end;
+    Context &context;
+};
+
+template <class I, class S>
+AstTaskParallelProcessingBase<I, S>::AstTaskParallelProcessingBase()
+    : numberOfThreads(0), subtreeSizeThreshold(1000)
+{
+}
+
+template <class I, class S>
+void
+AstTaskParallelProcessingBase<I, S>::set_numberOfThreads(size_t threads)
+{
+    numberOfThreads = threads;
+}
+
+template <class I, class S>
+size_t
+AstTaskParallelProcessingBase<I, S>::get_numberOfThreads() const
+{
+    return numberOfThreads;
+}
+
+template <class I, class S>
+void
+AstTaskParallelProcessingBase<I, S>::set_subtreeSizeThreshold(size_t threshold)
+{
+    ROSE_ASSERT(threshold > 0);
+    subtreeSizeThreshold = threshold;
+}
+
+template <class I, class S>
+size_t
+AstTaskParallelProcessingBase<I, S>::get_subtreeSizeThreshold() const
+{
+    return subtreeSizeThreshold;
+}
+
+template <class I, class S>
+S
+AstTaskParallelProcessingBase<I, S>::traverseTasks(SgNode *basenode, I inheritedValue)
+{
+    AstTaskParallelWorkPool pool(numberOfThreads);
+    Context context;
+
+    // Splitting doesn't help with one thread or with an AST that is too small to split.
+    if (basenode == NULL || pool.get_numberOfThreads() == 1 || countNodes(basenode, context) < subtreeSizeThreshold)
+        return traverseSerially(basenode, inheritedValue);
+
+    try
+    {
+        pool.run(new RootTask(this, basenode, inheritedValue, context));
+    }
+    catch (...)
+    {
+        for (size_t i = 0; i < context.joins.size(); i++)
+            delete context.joins[i];
+        throw;
+    }
+
+    for (size_t i = 0; i < context.joins.size(); i++)
+        delete context.joins[i];
+    return context.result;
+}
+
+// Returns the number of nodes in the subtree, and records the sizes of the subtrees that will be split into tasks.
+template <class I, class S>
+size_t
+AstTaskParallelProcessingBase<I, S>::countNodes(SgNode *node, Context &context)
+{
+    size_t numberOfSuccessors = node->get_numberOfTraversalSuccessors();
+    size_t firstSuccessor = context.successorSizes.size();
+    size_t size = 1;
+    for (size_t idx = 0; idx < numberOfSuccessors; idx++)
+    {
+        SgNode *child = node->get_traversalSuccessorByIndex(idx);
+        size_t childSize = child != NULL ? countNodes(child, context) : 0;
+        context.successorSizes.push_back(childSize);
+        size += childSize;
+    }
+
+    if (size >= subtreeSizeThreshold)
+    {
+        context.sizes[node] = size;
+        for (size_t idx = 0; idx < numberOfSuccessors; idx++)
+        {
+            SgNode *child = node->get_traversalSuccessorByIndex(idx);
+            if (child != NULL)
+                context.sizes[child] = context.successorSizes[firstSuccessor + idx];
+        }
+    }
+    context.successorSizes.resize(firstSuccessor);
+    return size;
+}
+
+// Traverses the subtree of a node and delivers its synthesized attribute to the parent's join. A subtree that is large
+// enough is split: the node's inherited attribute is evaluated here, and its successors' subtrees are traversed by new
+// tasks. Consecutive small subtrees are grouped into one task, and the last task is run by this task.
+template <class I, class S>
+void
+AstTaskParallelProcessingBase<I, S>::traverseSubtree(AstTaskParallelWorkPool &pool, SgNode *node, I inheritedValue,
+                                                     Join *parent, size_t index, Context &context, size_t worker)
+{
+    typename boost::unordered_map<SgNode*, size_t>::const_iterator found = context.sizes.find(node);
+    if (found == context.sizes.end() || found->second < subtreeSizeThreshold)
+    {
+        deliver(parent, index, traverseSerially(node, inheritedValue), context);
+        return;
+    }
+
+    inheritedValue = taskEvaluateInheritedAttribute(node, inheritedValue);
+    size_t numberOfSuccessors = node->get_numberOfTraversalSuccessors();
+    if (numberOfSuccessors == 0)
+    {
+        SynthesizedAttributesList noAttributes;
+        deliver(parent, index, taskEvaluateSynthesizedAttribute(node, inheritedValue, noAttributes), context);
+        return;
+    }
+
+    Join *join = new Join(node, inheritedValue, numberOfSuccessors, parent, index);
+    {
+        SAWYER_THREAD_TRAITS::LockGuard lock(context.mutex);
+        context.joins.push_back(join);
+    }
+
+    size_t begin = 0, groupSize = 0;
+    for (size_t idx = 0; idx < numberOfSuccessors; idx++)
+    {
+        SgNode *child = node->get_traversalSuccessorByIndex(idx);
+        if (child != NULL)
+        {
+            found = context.sizes.find(child);
+            ROSE_ASSERT(found != context.sizes.end());
+            groupSize += found->second;
+        }
+        if (idx + 1 == numberOfSuccessors)
+        {
+            SubtreeTask last(this, join, begin, numberOfSuccessors, context);
+            last.run(pool, worker);
+        }
+        else if (groupSize >= subtreeSizeThreshold)
+        {
+            pool.spawn(worker, new SubtreeTask(this, join, begin, idx + 1, context));
+            begin = idx + 1;
+            groupSize = 0;
+        }
+    }
+}
+
+// Stores the synthesized attribute of successor index of the node of a join. If it was the last one missing, the node's
+// synthesized attribute is evaluated and delivered to the parent's join, and so on. The attribute of the root is the result
+// of the traversal.
+template <class I, class S>
+void
+AstTaskParallelProcessingBase<I, S>::deliver(Join *join, size_t index, S value, Context &context)
+{
+    while (join != NULL)
+    {
+        {
+            SAWYER_THREAD_TRAITS::LockGuard lock(join->mutex);
+            join->results[index] = value;
+            if (--join->pending > 0)
+                return;
+        }
+
+        // All other tasks are done with this join, so its results can be read without locking.
+        SynthesizedAttributesList attributes;
+        for (size_t i = 0; i < join->results.size(); i++)
+            attributes.push(join->results[i]);
+        attributes.setFrameSize(join->results.size());
+        ROSE_ASSERT(attributes.size() == join->results.size());
+        value = taskEvaluateSynthesizedAttribute(join->node, join->inheritedValue, attributes);
+        index = join->index;
+        join = join->parent;
+    }
+    context.result = value;
+}
+
+template <class I, class S>
+S
+AstTaskParallelProcessingBase<I, S>::traverseSerially(SgNode *node, I inheritedValue)
+{
+    SynthesizedAttributesList stack;
+    performSerialTraversal(node, inheritedValue, stack);
+    return stack.pop();
+}
+
+// Same as SgTreeTraversal::performTraversal() for a traversal that is both preorder and postorder, but with a stack that
+// is local to the task.
+template <class I, class S>
+void
+AstTaskParallelProcessingBase<I, S>::performSerialTraversal(SgNode *node, I inheritedValue, SynthesizedAttributesList &stack)
+{
+    if (node != NULL)
+    {
+        inheritedValue = taskEvaluateInheritedAttribute(node, inheritedValue);
+        size_t numberOfSuccessors = node->get_numberOfTraversalSuccessors();
+        for (size_t idx = 0; idx < numberOfSuccessors; idx++)
+        {
+            SgNode *child = node->get_traversalSuccessorByIndex(idx);
+            if (child != NULL)
+                performSerialTraversal(child, inheritedValue, stack);
+            else
+                stack.push(taskDefaultSynthesizedAttribute(inheritedValue));
+        }
+        stack.setFrameSize(numberOfSuccessors);
+        ROSE_ASSERT(stack.size() == numberOfSuccessors);
+        stack.push(taskEvaluateSynthesizedAttribute(node, inheritedValue, stack));
+    }
+    else
+    {
+        stack.push(taskDefaultSynthesizedAttribute(inheritedValue));
+    }
+}
+
+/////////////////////////////////////////////////////////
+//// TOP DOWN BOTTOM UP TASK-PARALLEL IMPLEMENTATION ////
+/////////////////////////////////////////////////////////
+
+template <class InheritedAttributeType, class SynthesizedAttributeType>
+SynthesizedAttributeType
+AstTaskParallelTopDownBottomUpProcessing<InheritedAttributeType, SynthesizedAttributeType>::
+traverseInParallel(SgNode *basenode, InheritedAttributeType inheritedValue)
+{
+    this->atTraversalStart();
+    SynthesizedAttributeType result = this->traverseTasks(basenode, inheritedValue);
+    this->atTraversalEnd();
+    return result;
+}
+
+template <class InheritedAttributeType, class SynthesizedAttributeType>
+InheritedAttributeType
+AstTaskParallelTopDownBottomUpProcessing<InheritedAttributeType, SynthesizedAttributeType>::
+taskEvaluateInheritedAttribute(SgNode *astNode, InheritedAttributeType inheritedValue)
+{
+    return this->evaluateInheritedAttribute(astNode, inheritedValue);
+}
+
+template <class InheritedAttributeType, class SynthesizedAttributeType>
+SynthesizedAttributeType
+AstTaskParallelTopDownBottomUpProcessing<InheritedAttributeType, SynthesizedAttributeType>::
+taskEvaluateSynthesizedAttribute(SgNode *astNode, InheritedAttributeType inheritedValue, SynthesizedAttributesList l)
+{
+    return this->evaluateSynthesizedAttribute(astNode, inheritedValue, l);
+}
+
+template <class InheritedAttributeType, class SynthesizedAttributeType>
+SynthesizedAttributeType
+AstTaskParallelTopDownBottomUpProcessing<InheritedAttributeType, SynthesizedAttributeType>::
+taskDefaultSynthesizedAttribute(InheritedAttributeType inheritedValue)
+{
+    return this->defaultSynthesizedAttribute(inheritedValue);
+}
+
+///////////////////////////////////////////////
+//// TOP DOWN TASK-PARALLEL IMPLEMENTATION ////
+///////////////////////////////////////////////
+
+template <class InheritedAttributeType>
+void
+AstTaskParallelTopDownProcessing<InheritedAttributeType>::
+traverseInParallel(SgNode *basenode, InheritedAttributeType inheritedValue)
+{
+    this->atTraversalStart();
+    this->traverseTasks(basenode, inheritedValue);
+    this->atTraversalEnd();
+}
+
+template <class InheritedAttributeType>
+InheritedAttributeType
+AstTaskParallelTopDownProcessing<InheritedAttributeType>::
+taskEvaluateInheritedAttribute(SgNode *astNode, InheritedAttributeType inheritedValue)
+{
+    return this->evaluateInheritedAttribute(astNode, inheritedValue);
+}
+
+template <class InheritedAttributeType>
+DummyAttribute
+AstTaskParallelTopDownProcessing<InheritedAttributeType>::
+taskEvaluateSynthesizedAttribute(SgNode *astNode, InheritedAttributeType inheritedValue, SynthesizedAttributesList)
+{
+    // call the cleanup function
+    this->destroyInheritedValue(astNode, inheritedValue);
+    // return value is not used
+    DummyAttribute a = defaultDummyAttribute;
+    return a;
+}
+
+template <class InheritedAttributeType>
+DummyAttribute
+AstTaskParallelTopDownProcessing<InheritedAttributeType>::
+taskDefaultSynthesizedAttribute(InheritedAttributeType)
+{
+    // called but not used
+    DummyAttribute a = defaultDummyAttribute;
+    return a;
+}
+
+////////////////////////////////////////////////
+//// BOTTOM UP TASK-PARALLEL IMPLEMENTATION ////
+////////////////////////////////////////////////
+
+template <class SynthesizedAttributeType>
+SynthesizedAttributeType
+AstTaskParallelBottomUpProcessing<SynthesizedAttributeType>::
+traverseInParallel(SgNode *basenode)
+{
+    this->atTraversalStart();
+    SynthesizedAttributeType result = this->traverseTasks(basenode, defaultDummyAttribute);
+    this->atTraversalEnd();
+    return result;
+}
+
+template <class SynthesizedAttributeType>
+DummyAttribute
+AstTaskParallelBottomUpProcessing<SynthesizedAttributeType>::
+taskEvaluateInheritedAttribute(SgNode *, DummyAttribute inheritedValue)
+{
+    return inheritedValue;
+}
+
+template <class SynthesizedAttributeType>
+SynthesizedAttributeType
+AstTaskParallelBottomUpProcessing<SynthesizedAttributeType>::
+taskEvaluateSynthesizedAttribute(SgNode *astNode, DummyAttribute, SynthesizedAttributesList l)
+{
+    return this->evaluateSynthesizedAttribute(astNode, l);
+}
+
+template <class SynthesizedAttributeType>
+SynthesizedAttributeType
+AstTaskParallelBottomUpProcessing<SynthesizedAttributeType>::
+taskDefaultSynthesizedAttribute(DummyAttribute)
+{
+    return this->defaultSynthesizedAttribute();
+}
+
+#endif
@@ -5,6 +5,8 @@
 #include "AstProcessing.h"
 #include "astQuery.h"
 #include <functional>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 #include "rosedll.h"
 
 // #include "variantVector.h"
@@ -187,6 +189,80 @@ namespace NodeQuery
   void pushNewNode ( NodeQuerySynthesizedAttributeType* nodeList, const VariantVector & targetVariantVector, SgNode * astNode);
   void* querySolverGrammarElementFromVariantVector ( SgNode * astNode, VariantVector targetVariantVector,  NodeQuerySynthesizedAttributeType* returnNodeList );
   NodeQuerySynthesizedAttributeType querySolverGrammarElementFromVariantVector ( SgNode * astNode, VariantVector targetVariantVector );
+  void pushQueryCandidates ( SgNode * astNode, Rose_STL_Container<SgNode*> & candidateList );
+
+  /********************************************************************************************
+   * The class
+   *    VariantIndex
+   * indexes the nodes of an AST by variant so that the variant queries of a subtree need not
+   * traverse the subtree. Every traversed node is numbered in preorder along with the nodes a
+   * variant query collects at that node (the node itself and the types it refers to which are
+   * not traversed), so the nodes collected in any subtree are numbered by one interval. The
+   * entries for each variant are sorted by number, which turns a query into two binary searches
+   * per variant and a copy of the entries between them.
+   *
+   * An index describes the AST as it was when the index was built. See buildVariantIndex().
+   *******************************************************************************************/
+  class ROSE_DLL_API VariantIndex
+     {
+       public:
+         // Index the AST rooted at 'root'
+            explicit VariantIndex ( SgNode * root );
+
+            SgNode* get_root () const { return root_; }
+
+         // Number of nodes visited by the traversal of the root.
+            size_t numberOfNodes () const { return intervals_.size(); }
+
+         // True if 'subTree' is visited by the traversal of the root.
+            bool contains ( SgNode * subTree ) const { return intervals_.find(subTree) != intervals_.end(); }
+
+         // True if 'node' is visited by the traversal of the root or is returned by a query, such as a type referred to by a
+         // visited node.
+            bool refersTo ( SgNode * node ) const { return contains(node) || others_.find(node) != others_.end(); }
+
+         // Append to returnList the nodes that querySubTree(subTree, targetVariantVector) would return. Returns false, without
+         // changing the list, if subTree is not visited by the traversal of the root.
+            bool querySubTree ( SgNode * subTree, const VariantVector & targetVariantVector, NodeQuerySynthesizedAttributeType & returnList ) const;
+
+       private:
+            struct Entry
+               {
+                 size_t number;
+                 SgNode * node;
+                 Entry ( size_t n, SgNode * p ) : number(n), node(p) {}
+                 bool operator< ( const Entry & other ) const { return number < other.number; }
+               };
+
+         // Numbers [first,second) are used by each traversed node's subtree
+            typedef boost::unordered_map<SgNode*, std::pair<size_t, size_t> > Intervals;
+
+            class Builder;
+
+            SgNode * root_;
+            Intervals intervals_;
+            boost::unordered_set<SgNode*> others_;          // query results that are not visited by the traversal
+            std::vector<std::vector<Entry> > entries_;      // sorted entries indexed by VariantT
+     };
+
+  /********************************************************************************************
+   * The functions
+   *    buildVariantIndex (SgNode * root), invalidateVariantIndex ()
+   * replace and discard the VariantIndex used by querySubTree(..., VariantT) and
+   * querySubTree(..., VariantVector) to answer AllNodes queries of subtrees of 'root'. Other
+   * queries still traverse. The index should be built after the AST is complete, such as right
+   * after the frontend, and it must be invalidated whenever the AST changes. The SageInterface
+   * functions that change the AST invalidate it, and deleting any node the index refers to
+   * invalidates it (see SgNode::set_destructorCallback). Code that changes the AST in other ways,
+   * such as calling set_parent or the set_* access functions directly, must call
+   * invalidateVariantIndex() itself. Building or invalidating the index while other threads query
+   * is not supported.
+   *******************************************************************************************/
+  ROSE_DLL_API void buildVariantIndex ( SgNode * root );
+  ROSE_DLL_API void invalidateVariantIndex ();
+
+  // The index used by querySubTree, or NULL if there is none.
+  ROSE_DLL_API const VariantIndex* getVariantIndex ();
 
 
    /********************************************************************************************
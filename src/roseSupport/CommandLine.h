@@ -132,6 +132,9 @@ struct GenericSwitchArgs {
                                                          *   The empty string means no solver is used. Additional switches
                                                          *   might be present to override this global solver for specific
                                                          *   situations. */
+    std::string smtMemoizationFile;                     /**< Name of a file in which SMT solver results are memoized across
+                                                         *   runs and processes. The empty string means results are memoized
+                                                         *   only within each solver object. */
 
     GenericSwitchArgs()
         : threads(0), smtSolver("none") {}